@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Root.h"
+
+namespace ecs
+{
+
+namespace impl
+{
+
+/**
+ * @brief The state shared by a CancellationSource and all its tokens.
+ */
+struct CancellationState
+{
+	std::atomic<bool> cancelled{false};  /**< True if the source has been cancelled. */
+};
+
+}  // namespace impl
+
+/**
+ * @brief The read-only view of a cancellation request, passed to tasks.
+ *
+ * Queued tasks with a cancelled token are dropped without running. Running tasks may poll
+ *   isCancelled() and return early. A default-constructed token is never cancelled.
+ */
+class CancellationToken
+{
+public:
+	/**
+	 * @brief The constructor of the token which is never cancelled.
+	 */
+	CancellationToken() = default;
+
+	/**
+	 * @brief Checks whether the cancellation has been requested.
+	 * @return True if cancelled.
+	 */
+	const bool isCancelled() const noexcept;
+
+	/**
+	 * @brief Checks whether the token is connected to a CancellationSource.
+	 * @return True if the token may be cancelled.
+	 */
+	const bool canBeCancelled() const noexcept;
+
+private:
+	friend class CancellationSource;
+
+	/**
+	 * @brief The constructor used by CancellationSource::token().
+	 * @param state The state shared with the source.
+	 */
+	explicit CancellationToken(std::shared_ptr<const impl::CancellationState> state);
+
+	std::shared_ptr<const impl::CancellationState> m_state;  /**< The state, empty if never cancelled. */
+};
+
+/**
+ * @brief The owner of a cancellation request, which can cancel a whole group of tasks.
+ *
+ * Example:
+ * @code
+ * ecs::CancellationSource optional_work;
+ * ecs::TaskOptions options;
+ * options.token = optional_work.token();
+ * TP.addTask(options, [](const int id) { updateLODs(); });
+ * if(frameOverrun()) { optional_work.cancel(); }  // queued LOD updates are dropped
+ * @endcode
+ */
+class CancellationSource
+{
+public:
+	/**
+	 * @brief The constructor of the source which is not cancelled.
+	 */
+	CancellationSource();
+
+	/**
+	 * @brief Gets the token observing this source.
+	 * @return The token.
+	 */
+	CancellationToken token() const;
+
+	/**
+	 * @brief Requests cancellation of all tasks holding tokens of this source.
+	 */
+	void cancel() noexcept;
+
+	/**
+	 * @brief Checks whether the cancellation has been requested.
+	 * @return True if cancelled.
+	 */
+	const bool isCancelled() const noexcept;
+
+private:
+	std::shared_ptr<impl::CancellationState> m_state;  /**< The state shared with tokens. */
+};
+
+}  // namespace ecs
@@ -2,6 +2,7 @@
 
 #include "Meta.h"
 #include "ComponentWrapper.h"
+#include "RaceDetector.h"
 
 namespace ecs
 {
@@ -12,6 +13,64 @@ namespace meta
 	using ComponentPool = TypeList<Typepack ...>;
 }  // namespace meta
 
+/**
+ * @brief The container holding all wrapped components of a single type.
+ * @tparam ComponentT The type of held components.
+ *
+ * Buckets allocate through std::pmr::polymorphic_allocator, so the memory resource passed to the
+ *   ComponentBuffer (or Manager) decides where the components live.
+ */
+template <typename ComponentT>
+using ComponentBucket = std::pmr::vector<ComponentWrapper<ComponentT>>;
+
+/**
+ * @brief The kind of structural change reported to component observers.
+ */
+enum class ComponentEvent
+{
+	Added,   /**< Components were added to entities. */
+	Removed  /**< Components were removed from entities (or the entities were deleted). */
+};
+
+/**
+ * @brief The callback receiving ids of all entities affected since the previous flush.
+ */
+using ComponentObserver = std::function<void(Span<const uint64> entity_ids)>;
+
+namespace impl
+{
+
+/**
+ * @brief Observers of one component type with changes pending for them.
+ */
+struct ComponentObservers
+{
+	std::vector<std::pair<uint64, ComponentObserver>> onAdded;    /**< Observers of ComponentEvent::Added with their ids. */
+	std::vector<std::pair<uint64, ComponentObserver>> onRemoved;  /**< Observers of ComponentEvent::Removed with their ids. */
+	std::vector<uint64> added;    /**< Entities which received the component since the last flush. */
+	std::vector<uint64> removed;  /**< Entities which lost the component since the last flush. */
+
+	/**
+	 * @brief Checks whether changes of the component have to be recorded.
+	 * @return True if there is any observer.
+	 */
+	const bool active() const noexcept
+	{
+		return !onAdded.empty() || !onRemoved.empty();
+	}
+};
+
+/**
+ * @brief The owning group of component types, see ComponentBuffer::group().
+ */
+struct OwningGroup
+{
+	uint64 owned = uint64{0};  /**< The bitset of owned component types. */
+	std::size_t size = 0u;     /**< The number of entities having all owned components. */
+};
+
+}  // namespace impl
+
 // ################################################################################################
 // ComponentBuffer
 
@@ -35,7 +94,17 @@ class ComponentBuffer<meta::TypeList<Typepack...>>
 	using m_cPool = meta::ComponentPool<ComponentWrapper<Typepack> ...>;  // WRAPPED
 	using m_tPool = meta::TypeList<Typepack...>;  // NOT WRAPPED
 public:
-	ComponentBuffer(const uint64 max_entity_count = uint64{1000});
+	/**
+	 * @brief The constructor.
+	 * @param max_entity_count The maximum entity count possible to add to the buffer.
+	 * @param resource The memory resource used by all component buckets.
+	 *
+	 * Constructor reserves enough memory for all entities fitting in the max cap. The resource has
+	 *   to outlive the buffer.
+	 */
+	ComponentBuffer(
+		const uint64 max_entity_count = uint64{1000},
+		std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 	
 	/**
 	 * @brief Gets the vector of components of given type.
@@ -45,7 +114,23 @@ public:
 	 * @note This method returns vector of wrapped components.
 	 */
 	template <typename ComponentT>
-	std::vector<ComponentWrapper<ComponentT>> &getComponentBucket();
+	ComponentBucket<ComponentT> &getComponentBucket();
+
+	/**
+	 * @brief Gets the read-only vector of components of given type.
+	 * @tparam ComponentT The type of the requested component.
+	 * @return The component bucket if the given type exists, otherwise an exception is thrown.
+	 *
+	 * Unlike the non-const version, the access is recorded in the race detector as a read.
+	 */
+	template <typename ComponentT>
+	const ComponentBucket<ComponentT> &getComponentBucket() const;
+
+	/**
+	 * @brief Gets the memory resource used by all component buckets.
+	 * @return The memory resource.
+	 */
+	std::pmr::memory_resource *getMemoryResource() const noexcept;
 	
 	/**
 	 * @brief Tries to get the specific component from the buffer.
@@ -60,7 +145,7 @@ public:
 	/**
 	 * @brief Gets the requested component of given type and entity id.
 	 * @param entity_id The entity identifier (automatically attached to every created entity).
-	 * @tparam ComponentT The type of the requested component.
+	 * @tparam ComponentT The type of the requested component, const-qualified for read-only access.
 	 * @return If the type and entity id exists, the requested component is returned.
 	 * 
 	 * @warning This method is unsafe, beacuse if any of the passed arguments/params are invalid,
@@ -102,6 +187,83 @@ public:
 	template <typename ComponentT>
 	auto &addComponent(const uint64 entity_id);
 
+	/**
+	 * @brief Adds copies of the prototype component to consecutive entity ids.
+	 * @param first_entity_id The entity identifier of the first entity.
+	 * @param count The number of added components (entity ids are first_entity_id + 0..count-1).
+	 * @param prototype The component instance copied to every entity.
+	 * @param join_groups False if the caller calls joinGroups() once all components of the batch
+	 *        are added (e.g. every component type of spawned entities).
+	 * @tparam ComponentT The type of the added components.
+	 *
+	 * The bucket is reallocated at most once and components are appended in a single pass, which
+	 *   for trivially copyable components compiles down to plain memory copies.
+	 *
+	 * @warning Just like addComponent(), this method does not check whether such components
+	 *          already exist.
+	 */
+	template <typename ComponentT>
+	void addComponents(
+		const uint64 first_entity_id,
+		const uint64 count,
+		const ComponentT &prototype,
+		const bool join_groups = true);
+
+	/**
+	 * @brief Moves entities which have just received components into the groups owning them.
+	 * @param components The bitset of received component types.
+	 * @param first_entity_id The entity identifier of the first entity.
+	 * @param count The number of entities (entity ids are first_entity_id + 0..count-1).
+	 * @param new_entities True if entities had no components before, then groups owning any type
+	 *        outside of the bitset are skipped.
+	 *
+	 * Every touched group is updated once: entities of small batches join it one by one, larger
+	 *   batches rebuild it in a single pass.
+	 */
+	void joinGroups(
+		const uint64 components,
+		const uint64 first_entity_id,
+		const uint64 count,
+		const bool new_entities = false);
+
+	/**
+	 * @brief Moves components from the caller's array to consecutive entity ids.
+	 * @param first_entity_id The entity identifier of the first entity.
+	 * @param components The components of entities first_entity_id + 0..size-1, left moved-from.
+	 * @tparam ComponentT The type of the inserted components.
+	 *
+	 * This is the bulk insert of data produced elsewhere. Components are interleaved with their
+	 *   entity ids in the bucket, so they are moved (copied if trivially copyable) once, in a
+	 *   single pass after at most one reallocation. The array stays owned by the caller.
+	 *
+	 * @warning Just like addComponents(), this method does not check whether such components
+	 *          already exist.
+	 */
+	template <typename ComponentT>
+	void insertComponents(const uint64 first_entity_id, Span<ComponentT> components);
+
+	/**
+	 * @brief Gets the strided view of components of the bucket.
+	 * @tparam ComponentT The type of the viewed components.
+	 * @return The view with the stride of ComponentWrapper, valid until the bucket changes.
+	 *
+	 * Components are interleaved with entity ids, so the view is not contiguous. It can be passed
+	 *   to libraries taking strided data (e.g. vertex attributes), others need a packed copy.
+	 *   Entity ids of the same positions are available from getComponentBucket().
+	 */
+	template <typename ComponentT>
+	StridedSpan<ComponentT> viewComponents();
+
+	/**
+	 * @brief Gets the strided view of components of the bucket.
+	 * @tparam ComponentT The type of the viewed components.
+	 * @return The read-only view with the stride of ComponentWrapper.
+	 *
+	 * This is a const version of this method provided for convenience.
+	 */
+	template <typename ComponentT>
+	StridedSpan<const ComponentT> viewComponents() const;
+
 	/**
 	 * @brief Adds a new component using decimal index of its type in the pool.
 	 * @param entity_id The entity identifier (automatically attached to every created entity).
@@ -175,10 +337,10 @@ public:
 	 * @brief Removes all components from the buffer belonging to the given entity id.
 	 * @param entity_id The entity identifier (automatically attached to every created entity).
 	 * 
-	 * @note This method is safe to use as it will not throw any exception and given arguments can
-	 *       be invalid.
+	 * @note Given arguments can be invalid. The only exception thrown is std::bad_alloc, when the
+	 *       removal is recorded for active observers of a component type.
 	 */
-	void removeComponents(const uint64 entity_id) noexcept;
+	void removeComponents(const uint64 entity_id);
 
 	// Remove single component with given type and Entity ID. Both arguments must be valid.
 
@@ -193,6 +355,110 @@ public:
 	template <typename ComponentT>
 	void removeComponent(const uint64 entity_id);
 
+	/**
+	 * @brief Chooses how removed components leave their buckets.
+	 * @param enabled True if removed components are erased, false if they are swapped with the last
+	 *        one (false by default).
+	 *
+	 * Erasing is O(n), but the order of remaining components does not depend on the order of
+	 *   removals, which makes parallel simulations reproducible (see Manager::setDeterministic()).
+	 */
+	void setStableRemoval(const bool enabled) noexcept;
+
+	/**
+	 * @brief Registers the observer of added or removed components of given type.
+	 * @param event The observed kind of change.
+	 * @param observer The callback receiving ids of affected entities.
+	 * @tparam ComponentT The observed type of the component.
+	 * @return The id of the observer used by unobserve().
+	 *
+	 * Changes are not reported by the modifying calls. They are collected per component type and
+	 *   delivered by flushObservers() as one span of entity ids per observer, so the cost of
+	 *   keeping external indices (spatial hashes, interest sets) in sync is paid once per frame.
+	 *   Types without observers record nothing.
+	 *
+	 * @code
+	 * buffer.observe<Position>(ecs::ComponentEvent::Added, [&grid](ecs::Span<const ecs::uint64> ids)
+	 * {
+	 *     for(auto id : ids) grid.insert(id);
+	 * });
+	 * @endcode
+	 */
+	template <typename ComponentT>
+	const uint64 observe(const ComponentEvent event, ComponentObserver observer);
+
+	/**
+	 * @brief Removes the observer registered by observe().
+	 * @param observer_id The id of the observer.
+	 *
+	 * If the given id is incorrect, this method does nothing.
+	 */
+	void unobserve(const uint64 observer_id);
+
+	/**
+	 * @brief Delivers all changes recorded since the previous flush to the observers.
+	 *
+	 * Changes cancelling each other (e.g. a component added and removed again) are not reported,
+	 *   so every span describes the net change. Changes made by observers themselves are delivered
+	 *   by the next flush.
+	 */
+	void flushObservers();
+
+	/**
+	 * @brief Reorders the bucket of given type by values of components.
+	 * @param compare The comparator of two components (strict weak ordering).
+	 * @param mode The sorting algorithm.
+	 * @tparam ComponentT The type of sorted components.
+	 *
+	 * Only the single bucket is sorted, see Manager::sort() to keep all buckets coherent.
+	 */
+	template <typename ComponentT, typename CompareT>
+	void sort(CompareT compare, const SortMode mode = SortMode::Full);
+
+	/**
+	 * @brief Reorders every bucket by ranks of entities owning the components.
+	 * @param ranks The position of every entity id, all entities of the buffer have to be present.
+	 * @param mode The sorting algorithm.
+	 *
+	 * Components of different types belonging to the same entities end up in the same relative
+	 *   order, so buckets can be walked in lockstep with the entity buffer.
+	 */
+	void arrange(const std::unordered_map<uint64, uint64> &ranks, const SortMode mode = SortMode::Full);
+
+	/**
+	 * @brief Creates the owning group of component types.
+	 * @tparam ComponentTs Types of components owned by the group.
+	 *
+	 * Entities having all components of the group are kept at the front of every owned bucket,
+	 *   in identical order. Iterating the group is then a lockstep walk over indices
+	 *   [0, groupSize()) of the owned buckets, without lookups or bitset checks. Membership is
+	 *   maintained by swaps whenever owned components are added or removed, and sort() and
+	 *   arrange() keep members at the front.
+	 *
+	 * Creating an already existing group does nothing. If any of the types is owned by another
+	 *   group, this method throws std::logic_error.
+	 */
+	template <typename... ComponentTs>
+	void group();
+
+	/**
+	 * @brief Gets the number of entities in the owning group.
+	 * @tparam ComponentTs Types of components owned by the group (in any order).
+	 * @return The number of components at the front of every owned bucket belonging to the group.
+	 *
+	 * If there is no such group, this method throws std::invalid_argument.
+	 */
+	template <typename... ComponentTs>
+	const std::size_t groupSize() const;
+
+	/**
+	 * @brief Checks whether the owning group exists.
+	 * @tparam ComponentTs Types of components owned by the group (in any order).
+	 * @return True if group<ComponentTs...>() has been called.
+	 */
+	template <typename... ComponentTs>
+	const bool hasGroup() const noexcept;
+
 	/**
 	 * @brief Returns the current number of components in the buffer.
 	 * @return Decimal number of components in the buffer.
@@ -207,7 +473,7 @@ public:
 	 * The size value is acquired by calling getComponentBucket() method, so all safety/exception
 	 *   rules apply from it.
 	 * 
-	 * @see std::vector<ComponentWrapper<ComponentT>> &getComponentBucket()
+	 * @see ComponentBucket<ComponentT> &getComponentBucket()
 	 */
 	template <typename ComponentT>
 	const uint64 bucketSize() const;
@@ -219,9 +485,128 @@ public:
 	 */
 	void printAll() const;
 
+#if ECS_RACE_DETECTOR
+	/**
+	 * @brief Gets the race detector validating accesses to the buckets.
+	 * @return The race detector.
+	 */
+	debug::RaceDetector &getRaceDetector() noexcept;
+#endif
+
+private:
+	/**
+	 * @brief Gets the vector of components of given type without recording the access.
+	 *
+	 * @warning For internal use only.
+	 */
+	template <typename ComponentT>
+	ComponentBucket<ComponentT> &accessBucket();
+
+	/**
+	 * @brief Records the access to the bucket in the race detector (no-op if it's disabled).
+	 */
+	template <typename ComponentT>
+	void recordAccess(const debug::Access access) const;
+
+	/**
+	 * @brief Calls the function for every bucket of the bitset.
+	 * @param owned The bitset of component types.
+	 * @param function The function taking a bucket.
+	 *
+	 * @warning For internal use only.
+	 */
+	template <typename FunctionT>
+	void forEachBucket(const uint64 owned, FunctionT function);
+
+	/**
+	 * @brief Packs all members of the group at the front of owned buckets.
+	 * @param group The index of the group.
+	 * @param leader The index of the component type whose order is kept by members.
+	 *
+	 * @warning For internal use only.
+	 */
+	void rebuildGroup(const std::size_t group, const std::size_t leader);
+
+	/**
+	 * @brief Moves the entity into the group owning the component, if it has all owned components.
+	 * @param entity_id The entity which has just received the component.
+	 * @param position The index of the received component in its bucket.
+	 * @tparam Index Index of the component type in the pool.
+	 * @return The index of the received component after the move.
+	 *
+	 * @warning For internal use only.
+	 */
+	template <std::size_t Index>
+	const std::size_t joinGroup(const uint64 entity_id, const std::size_t position);
+
+	/**
+	 * @brief Moves the entity into the group, if it has all owned components.
+	 * @param group The index of the group.
+	 * @param entity_id The entity which has just received an owned component.
+	 * @return The index of the entity in owned buckets after the move, empty if it did not join.
+	 *
+	 * Received components are near the back of buckets, so they are searched for from there.
+	 *
+	 * @warning For internal use only.
+	 */
+	std::optional<std::size_t> joinMember(const std::size_t group, const uint64 entity_id);
+
+	/**
+	 * @brief Moves the entity out of the group owning the component, if it is a member.
+	 * @param entity_id The entity which is about to lose the component.
+	 * @tparam Index Index of the component type in the pool.
+	 *
+	 * @warning For internal use only.
+	 */
+	template <std::size_t Index>
+	void leaveGroup(const uint64 entity_id);
+
+	/**
+	 * @brief Moves components of the bucket to positions given by the order.
+	 * @param bucket The reordered bucket.
+	 * @param order The index of the component placed at every position.
+	 *
+	 * @warning For internal use only.
+	 */
+	template <typename BucketT>
+	static void permute(BucketT &bucket, const std::vector<std::size_t> &order);
+
+	/**
+	 * @brief Removes the component from the bucket according to the removal mode.
+	 * @param bucket The bucket holding the component.
+	 * @param position The removed component.
+	 *
+	 * @warning For internal use only.
+	 */
+	template <typename BucketT>
+	void eraseFrom(BucketT &bucket, const typename BucketT::iterator position);
+
+	/**
+	 * @brief Records the change of consecutive entity ids for observers of the component.
+	 * @param event The kind of change.
+	 * @param first_entity_id The first affected entity.
+	 * @param count The number of affected entities.
+	 * @tparam Index Index of the component type in the pool.
+	 *
+	 * @warning For internal use only.
+	 */
+	template <std::size_t Index>
+	void recordChange(const ComponentEvent event, const uint64 first_entity_id, const uint64 count = uint64{1});
+
 private:
 	meta::metautil::TupleOfVectorsOfTypes<m_cPool> m_cBuffer;  /**< Container holding all components in the buffer. */
 	uint64 m_maxEntityCount;                                   /**< Maximal possible number of entities which can fit into the buffer. */
+	std::pmr::memory_resource *m_resource;                     /**< Memory resource used by all component buckets. */
+	std::array<impl::ComponentObservers, sizeof... (Typepack)> m_observers;  /**< Observers of every component type. */
+	uint64 m_nextObserverID = uint64{1};                      /**< The id of the next registered observer. */
+	bool m_stableRemoval = false;                              /**< True if removed components keep the order of the rest. */
+	std::vector<impl::OwningGroup> m_groups;                   /**< All owning groups. */
+	std::array<std::size_t, sizeof... (Typepack)> m_groupOf;   /**< The group owning every component type, noGroup if none. */
+	static constexpr std::size_t noGroup = ~std::size_t{0};    /**< Marks component types not owned by any group. */
+	static constexpr uint64 joinBatchLimit = 64u;              /**< Larger batches rebuild groups instead of joining entities one by one. */
+#if ECS_RACE_DETECTOR
+	mutable debug::RaceDetector m_raceDetector;                /**< Validates accesses to the buckets. */
+#endif
 };
 
 }  // namespace ecs
@@ -34,6 +34,20 @@ public:
 	 */
 	explicit ComponentWrapper(const ComponentT &comp);
 
+	/**
+	 * @brief Special constructor which allows wrapping a copy of the component with given entity id.
+	 * @param comp The component instance which will be copied and wrapped.
+	 * @param entity_id The entity identifier (automatically attached to every created entity).
+	 */
+	ComponentWrapper(const ComponentT &comp, const uint64 &entity_id);
+
+	/**
+	 * @brief Special constructor which allows wrapping a moved component with given entity id.
+	 * @param comp The component instance which will be moved and wrapped.
+	 * @param entity_id The entity identifier (automatically attached to every created entity).
+	 */
+	ComponentWrapper(ComponentT &&comp, const uint64 &entity_id);
+
 	/**
 	 * @brief Parenthesis operator overload which gets the unwrapped component instance.
 	 * @return The unwrapped component instance
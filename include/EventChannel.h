@@ -0,0 +1,161 @@
+#pragma once
+
+#include "Root.h"
+#include "Util.h"
+#include "ThreadPool.h"
+
+namespace ecs
+{
+
+namespace impl
+{
+
+using EmitKey = std::pair<uint64, uint64>;  /**< The dispatch order of the emitting system and its first entity index. */
+
+/**
+ * @brief Gets the key of events emitted by the calling thread.
+ * @return The reference to the thread local key, {max, max} outside ranges of systems.
+ *
+ * @warning For internal use only.
+ */
+inline EmitKey &currentEmitKey() noexcept
+{
+	static thread_local EmitKey key(~uint64{0}, ~uint64{0});
+	return key;
+}
+
+/**
+ * @brief Sets the key of emitted events for the lifetime of the scope (e.g. a range of a system).
+ *
+ * @warning For internal use only.
+ */
+class EmitScope
+{
+public:
+	explicit EmitScope(const EmitKey &key) noexcept
+	:
+	m_previous(currentEmitKey())
+	{
+		currentEmitKey() = key;
+	}
+
+	~EmitScope()
+	{
+		currentEmitKey() = m_previous;
+	}
+
+	EmitScope(const EmitScope &) = delete;
+	EmitScope &operator=(const EmitScope &) = delete;
+
+private:
+	EmitKey m_previous;  /**< The key restored at the end of the scope. */
+};
+
+/**
+ * @brief The append buffer of events emitted by one worker thread.
+ *
+ * Buffers are aligned to separate cache lines, so workers appending at the same time do not
+ *   share any line.
+ *
+ * @warning For internal use only.
+ */
+template <typename EventT>
+struct alignas(64) EventBuffer
+{
+	std::vector<EventT> events;  /**< Events emitted in the current phase. */
+	std::vector<EmitKey> keys;   /**< Keys of events, filled only by ordered channels. */
+};
+
+}  // namespace impl
+
+/**
+ * @brief The typed, double-buffered channel of events emitted by systems (e.g. collisions or damage).
+ *
+ * Every worker of the ThreadPool appends to its own buffer, found by ThreadPool::currentWorkerIndex(),
+ *   so emitting takes no lock. Threads which are not workers of the pool share one buffer guarded
+ *   by a mutex. swap() ends the phase: emitted events are merged into one contiguous view read by
+ *   consumers in the next phase, while new events are emitted into the emptied buffers.
+ *
+ * @code
+ * ecs::EventChannel<Hit> hits(pool);
+ * manager.registerSystem([&hits](ecs::Interface &i, const Position &pos) { if(pos.y < 0.f) hits.emit(Hit{i.id()}); });
+ * manager.runSystems();
+ * hits.swap();
+ * for(const Hit &hit : hits.read()) { ... }
+ * @endcode
+ *
+ * The channel can be stored as a resource of the Manager, see Manager::getResources().
+ */
+template <typename EventT>
+class EventChannel
+{
+public:
+	/**
+	 * @brief The constructor.
+	 * @param pool The pool whose workers emit events.
+	 */
+	explicit EventChannel(ThreadPool &pool);
+
+	/**
+	 * @brief Appends the event to the buffer of the calling thread.
+	 * @param args Arguments passed to the constructor of the event.
+	 *
+	 * This method may be called by many threads at the same time, but not at the same time as swap().
+	 */
+	template <typename... Args>
+	void emit(Args &&...args);
+
+	/**
+	 * @brief Ends the phase, makes events emitted since the previous call readable.
+	 *
+	 * Events are merged in the order of worker indices, the events of other threads come last.
+	 *   Ordered channels sort them by their emitting system and range instead, see setOrdered().
+	 *   Events read in the previous phase are discarded. Buffers keep their capacity, so a steady
+	 *   stream of events does not allocate.
+	 *
+	 * @warning No thread may emit or read events during the swap.
+	 */
+	void swap();
+
+	/**
+	 * @brief Gets events of the previous phase.
+	 * @return The span of events, valid until the next swap().
+	 */
+	Span<const EventT> read() const noexcept;
+
+	/**
+	 * @brief Gets the number of readable events.
+	 * @return The number of events of the previous phase.
+	 */
+	const std::size_t size() const noexcept;
+
+	/**
+	 * @brief Removes all emitted and readable events.
+	 */
+	void clear();
+
+	/**
+	 * @brief Makes the order of merged events independent of the scheduling.
+	 * @param enabled True if events are merged in a reproducible order (false by default).
+	 *
+	 * Ranges of systems run by the Manager mark events with the dispatch order of the system and
+	 *   the first entity of the range. swap() sorts events by these keys and keeps the emission
+	 *   order within a range, so replays get identical events no matter which worker ran which
+	 *   range. Events emitted outside systems come last. It should be set between phases.
+	 *
+	 * @see Manager::setDeterministic()
+	 */
+	void setOrdered(const bool enabled) noexcept;
+
+private:
+	ThreadPool &m_pool;                                 /**< The pool whose workers emit events. */
+	std::vector<impl::EventBuffer<EventT>> m_buffers;   /**< Append buffers of workers, indexed by worker index. */
+	impl::EventBuffer<EventT> m_external;               /**< The buffer of threads which are not workers. */
+	std::mutex m_externalMutex;                         /**< Guards m_external. */
+	std::vector<EventT> m_read;                         /**< Merged events of the previous phase. */
+	bool m_ordered;                                     /**< True if events are sorted by their keys. */
+};
+
+}  // namespace ecs
+
+#include "../src/EventChannel.inl"
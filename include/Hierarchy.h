@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Root.h"
+#include "ThreadPool.h"
+#include "JobGraph.h"
+
+namespace ecs
+{
+
+/**
+ * @brief The parent/child relationship between entities (scene graphs, attachment trees).
+ *
+ * Every node stores its parent, first child and next sibling, so adding, moving and removing
+ *   entities is O(1) apart from the cycle check. Traversals use the cached depth-first order, in
+ *   which every parent comes before its children and every subtree is a contiguous range:
+ *
+ * @code
+ * ecs::Hierarchy &tree = manager.getHierarchy();
+ * tree.setParent(wheel, car);
+ * tree.setParent(bolt, wheel);
+ * manager.propagate<Transform>([](Transform &child, const Transform &parent) { child.world = parent.world * child.local; });
+ * @endcode
+ */
+class Hierarchy
+{
+public:
+	static constexpr uint64 none = ~uint64{0};  /**< The id returned when there is no such entity. */
+
+	/**
+	 * @brief The entity at one position of the depth-first order.
+	 */
+	struct Entry
+	{
+		uint64 entity;            /**< The entity id. */
+		uint64 parent;            /**< The id of the parent, Hierarchy::none for roots. */
+		std::size_t parentIndex;  /**< The position of the parent in the order, Hierarchy::none for roots. */
+		std::size_t subtreeEnd;   /**< The position after the last descendant, the subtree is [position, subtreeEnd). */
+	};
+
+	/**
+	 * @brief Attaches the entity to the parent, detaching it from the previous one.
+	 * @param child The attached entity, its subtree moves with it.
+	 * @param parent The new parent.
+	 *
+	 * Entities unknown to the hierarchy are added. If both ids are equal, this method throws
+	 *   std::invalid_argument. If the parent is a descendant of the child, this method throws
+	 *   std::logic_error.
+	 */
+	void setParent(const uint64 child, const uint64 parent);
+
+	/**
+	 * @brief Detaches the entity from its parent, making it a root.
+	 * @param entity The entity id.
+	 *
+	 * If the entity is not in the hierarchy, this method does nothing.
+	 */
+	void detach(const uint64 entity);
+
+	/**
+	 * @brief Removes the entity from the hierarchy, its children become roots.
+	 * @param entity The entity id.
+	 *
+	 * If the entity is not in the hierarchy, this method does nothing.
+	 */
+	void remove(const uint64 entity);
+
+	/**
+	 * @brief Removes all entities from the hierarchy.
+	 */
+	void clear();
+
+	/**
+	 * @brief Checks whether the entity is in the hierarchy.
+	 * @param entity The entity id.
+	 * @return True if the entity has ever been attached and has not been removed.
+	 */
+	const bool contains(const uint64 entity) const;
+
+	/**
+	 * @brief Gets the parent of the entity.
+	 * @param entity The entity id.
+	 * @return The parent id, Hierarchy::none for roots and unknown entities.
+	 */
+	const uint64 parentOf(const uint64 entity) const;
+
+	/**
+	 * @brief Gets the first child of the entity.
+	 * @param entity The entity id.
+	 * @return The child id, Hierarchy::none if there are no children.
+	 */
+	const uint64 firstChildOf(const uint64 entity) const;
+
+	/**
+	 * @brief Gets the next child of the same parent.
+	 * @param entity The entity id.
+	 * @return The sibling id, Hierarchy::none if the entity is the last child.
+	 */
+	const uint64 nextSiblingOf(const uint64 entity) const;
+
+	/**
+	 * @brief Gets the number of entities in the hierarchy.
+	 * @return The entity count.
+	 */
+	const std::size_t size() const;
+
+	/**
+	 * @brief Gets all entities in the depth-first order.
+	 * @return Entries ordered so that every parent precedes its children.
+	 *
+	 * The order is rebuilt only after the hierarchy has changed.
+	 */
+	const std::vector<Entry> &order();
+
+	/**
+	 * @brief Calls the function for all entities in the depth-first order.
+	 * @param pool The pool executing independent subtrees at the same time.
+	 * @param function The function called for every entry, after the entry of its parent.
+	 * @param options The options of added tasks (e.g. the lane).
+	 *
+	 * Small subtrees are processed by one task as contiguous ranges of the order. Larger subtrees
+	 *   are split below their root, every child subtree becoming a task which depends on the task
+	 *   of the parent, so even a single tree is spread over the pool. Every function call sees the
+	 *   results of its ancestors and no locking is needed.
+	 */
+	void propagate(
+		ThreadPool &pool,
+		const std::function<void(const Entry &entry)> &function,
+		const TaskOptions &options = TaskOptions{});
+
+private:
+	/**
+	 * @brief Gets the slot of the entity, creating it if the entity is unknown.
+	 *
+	 * @warning For internal use only.
+	 */
+	const std::size_t acquire(const uint64 entity);
+
+	/**
+	 * @brief Gets the slot of the entity.
+	 * @return The slot, Hierarchy::none if the entity is unknown.
+	 *
+	 * @warning For internal use only.
+	 */
+	const std::size_t find(const uint64 entity) const;
+
+	/**
+	 * @brief Removes the node from the children list of its parent.
+	 *
+	 * @warning For internal use only.
+	 */
+	void unlink(const std::size_t slot);
+
+private:
+	/**
+	 * @brief The entity with its relationship, links are slots of other nodes.
+	 */
+	struct Node
+	{
+		uint64 entity = none;             /**< The entity id, Hierarchy::none for free slots. */
+		std::size_t parent = none;       /**< The slot of the parent. */
+		std::size_t firstChild = none;   /**< The slot of the first child. */
+		std::size_t nextSibling = none;  /**< The slot of the next child of the same parent. */
+		std::size_t prevSibling = none;  /**< The slot of the previous child of the same parent. */
+	};
+
+	std::vector<Node> m_nodes;                      /**< All nodes, indexed by slots. */
+	std::vector<std::size_t> m_freeSlots;           /**< Slots of removed nodes waiting for reuse. */
+	std::unordered_map<uint64, std::size_t> m_slots; /**< The slot of every entity. */
+	std::vector<Entry> m_order;                     /**< The cached depth-first order. */
+	bool m_dirty = false;                           /**< True if the order has to be rebuilt. */
+};
+
+}  // namespace ecs
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Root.h"
+#include "Resources.h"
 
 namespace ecs
 {
@@ -18,11 +19,17 @@ public:
 	 * @param index The index of an entity in the buffer.
 	 * @param flag_bitset The flag bitset of an entity.
 	 * @param component_bitset The component bitset of an entity.
+	 * @param resources The resources of the world, nullptr if there are none.
 	 *
 	 * All these arguments can be used by the user in an ECS system. applySystem() method passes
 	 *   values corresponding to entities it operates on.
 	 */
-	Interface(const uint64 &id, const uint64 &index, uint64 &flag_bitset, const uint64 &component_bitset);
+	Interface(
+		const uint64 &id,
+		const uint64 &index,
+		uint64 &flag_bitset,
+		const uint64 &component_bitset,
+		Resources *resources = nullptr);
 
 	/**
 	 * @brief Gets the ID of an entity.
@@ -48,11 +55,33 @@ public:
 	 */
 	const uint64 &components() const;
 
+	/**
+	 * @brief Gets the resource of the world in O(1).
+	 * @tparam ResourceT The type of the resource.
+	 * @return The resource.
+	 *
+	 * If the Interface has no resources or there is no such resource, this method throws
+	 *   std::out_of_range. Registered systems should declare used resources, see ResourceAccess.
+	 */
+	template <typename ResourceT>
+	ResourceT &resource() const;
+
 private:
 	const uint64 &m_id;  /**< The entity's ID. */
 	const uint64 &m_index;  /**< The entity's index in the buffer. */
 	uint64 &m_flagBitset;  /**< The entity's flag bitset. */
 	const uint64 &m_compBitset;  /**< The entity's component bitset. */
+	Resources *m_resources;  /**< The resources of the world, nullptr if there are none. */
 };
 
+template <typename ResourceT>
+ResourceT &Interface::resource() const
+{
+	if(m_resources == nullptr)
+	{
+		throw std::out_of_range("template <typename ResourceT> ResourceT &Interface::resource(): There are no resources.");
+	}
+	return m_resources->get<ResourceT>();
+}
+
 }  // namespace ecs
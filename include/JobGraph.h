@@ -0,0 +1,155 @@
+#pragma once
+
+#include "Root.h"
+#include "ThreadPool.h"
+#include "JobHandle.h"
+
+namespace ecs
+{
+
+class JobGraph;
+
+namespace impl
+{
+
+/**
+ * @brief The state of one submission of a JobGraph, shared by all of its tasks.
+ */
+struct GraphRun
+{
+	const JobGraph *graph = nullptr;  /**< The submitted graph. */
+	ThreadPool *pool = nullptr;  /**< The pool executing jobs, nullptr if jobs are executed inline. */
+	TaskOptions options;  /**< The options of every added task. */
+	std::unique_ptr<std::atomic<unsigned>[]> pending;  /**< Unfinished dependencies of every job. */
+	std::atomic<bool> failed{false};  /**< True if any job has thrown, the remaining jobs are skipped. */
+	JobHandle handle;  /**< The handle of the whole submission. */
+};
+
+}  // namespace impl
+
+/**
+ * @brief The class representing a graph of jobs with dependencies, executed by the ThreadPool.
+ *
+ * Every job is added to the ThreadPool once its last dependency finishes. Dependencies are
+ *   tracked by atomic counters decremented by the finishing jobs, so nothing is polled and no
+ *   thread waits between the stages. A whole frame can be submitted at once:
+ *
+ * @code
+ * ecs::JobGraph frame;
+ * auto input = frame.addJob([]() { readInput(); });
+ * auto ai = frame.addJob([]() { think(); }, {input});
+ * auto physics = frame.addJob([]() { simulate(); }, {input});
+ * auto transform = frame.addJob([]() { updateTransforms(); }, {ai, physics});
+ * frame.addJob([]() { cull(); }, {transform});
+ * frame.submit(ecs::ThreadPool::shared()).wait();  // the graph can be submitted again every frame
+ * @endcode
+ *
+ * Jobs without a function only join their dependencies. They are completed by the thread
+ *   finishing the last dependency, without going through the queue.
+ */
+class JobGraph
+{
+public:
+	using JobID = std::size_t;  /**< The index of a job in the graph. */
+
+	/**
+	 * @brief Adds a new job to the graph.
+	 * @param job The function executed by one of the threads (may be empty).
+	 * @param dependencies The jobs which have to finish before this one starts.
+	 * @param node The NUMA node preferred for execution, see ThreadPool::setAffinity().
+	 * @return The index of the job.
+	 */
+	JobID addJob(
+		std::function<void()> job,
+		const std::vector<JobID> &dependencies = {},
+		const unsigned node = TaskOptions::anyNode);
+
+	/**
+	 * @brief Makes the job wait for the other one.
+	 * @param job The index of the waiting job.
+	 * @param dependency The index of the job which has to finish first.
+	 *
+	 * If any of indices is incorrect, this method throws std::invalid_argument.
+	 */
+	void addDependency(const JobID job, const JobID dependency);
+
+	/**
+	 * @brief Gets the number of jobs in the graph.
+	 * @return The job count.
+	 */
+	NDMESSAGE const std::size_t jobCount() const;
+
+	/**
+	 * @brief Removes all jobs from the graph.
+	 */
+	void clear();
+
+	/**
+	 * @brief Executes all jobs of the graph in the order of their dependencies.
+	 * @param pool The pool executing jobs. If it has no threads, jobs are executed by the caller.
+	 * @param options The options of added tasks (e.g. the lane), nodes of jobs take precedence.
+	 * @return The handle completed when all jobs finish. Its wait() rethrows the first exception
+	 *         thrown by a job, jobs not started before the exception are skipped.
+	 *
+	 * Once the token of options is cancelled or its deadline passes, functions of the remaining
+	 *   jobs are skipped, but the jobs still complete, so the handle is done as usual.
+	 *
+	 * If dependencies form a cycle, this method throws std::logic_error.
+	 *
+	 * @warning The graph must not be modified or destroyed until the returned job is done.
+	 */
+	JobHandle submit(ThreadPool &pool, const TaskOptions &options = TaskOptions{}) const;
+
+private:
+	/**
+	 * @brief Executes the job and all successors which can be completed by the same thread.
+	 * @param run The state of the submission.
+	 * @param job The index of the job ready for execution.
+	 *
+	 * @warning For internal use only.
+	 */
+	static void process(const std::shared_ptr<impl::GraphRun> &run, const JobID job);
+
+	/**
+	 * @brief Adds ready jobs to the pool of the submission, joining jobs are processed at once.
+	 * @param run The state of the submission.
+	 * @param jobs Indices of jobs ready for execution.
+	 *
+	 * @warning For internal use only.
+	 */
+	static void dispatch(const std::shared_ptr<impl::GraphRun> &run, const std::vector<JobID> &jobs);
+
+	/**
+	 * @brief Checks whether the token or the deadline of the submission skips remaining jobs.
+	 * @param run The state of the submission.
+	 * @return True if jobs should be skipped.
+	 *
+	 * @warning For internal use only.
+	 */
+	static const bool expired(const impl::GraphRun &run);
+
+	/**
+	 * @brief Checks whether dependencies of the graph form a cycle.
+	 * @return True if there is a cycle.
+	 *
+	 * @warning For internal use only.
+	 */
+	const bool hasCycle() const;
+
+private:
+	/**
+	 * @brief The job with its outgoing edges.
+	 */
+	struct Node
+	{
+		std::function<void()> job;  /**< The executed function, empty for joining jobs. */
+		std::vector<JobID> successors;  /**< Jobs waiting for this one. */
+		unsigned dependencyCount = 0u;  /**< The number of jobs this one waits for. */
+		unsigned node = TaskOptions::anyNode;  /**< The NUMA node preferred for execution. */
+	};
+
+	std::vector<Node> m_nodes;  /**< All jobs of the graph. */
+	bool m_ordered = true;  /**< True if every dependency was added before its job (no cycle is possible). */
+};
+
+}  // namespace ecs
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Root.h"
+
+namespace ecs
+{
+
+namespace impl
+{
+
+/**
+ * @brief Shared completion state of a job, see JobHandle.
+ */
+struct JobState
+{
+	std::atomic<unsigned> remaining{0u};  /**< The number of tasks which have not finished yet. */
+	bool done = false;  /**< True if all tasks have finished. */
+	std::vector<std::future<void>> futures;  /**< Futures of the tasks, used to rethrow their exceptions. */
+	std::exception_ptr exception;  /**< The exception thrown by a continuation or a graph job. */
+	std::vector<std::function<void()>> continuations;  /**< Functions run after the job completes. */
+	std::mutex mutex;  /**< The mutex guarding all non-atomic members. */
+	std::condition_variable cond;  /**< Notified when the job completes. */
+};
+
+}  // namespace impl
+
+/**
+ * @brief The lightweight handle of work running on the ThreadPool (e.g. all ranges of one system).
+ *
+ * The handle aggregates any number of tasks into one completion object. It can be copied freely,
+ *   all copies refer to the same job.
+ *
+ * Example:
+ * @code
+ * ecs::JobHandle physics = manager.applySystemAsync([](const Velocity &vel, Position &pos) { ... });
+ * renderPreviousFrame();  // overlaps with the system
+ * physics.then([]() { std::cout << "physics done"; });
+ * physics.wait();
+ * @endcode
+ */
+class JobHandle
+{
+public:
+	/**
+	 * @brief The constructor of an empty (already completed) job.
+	 */
+	JobHandle();
+
+	/**
+	 * @brief The constructor of a job consisting of the given number of tasks.
+	 * @param task_count The number of tasks, every one of them has to call completeTask().
+	 *
+	 * @warning For internal use only.
+	 */
+	explicit JobHandle(const unsigned task_count);
+
+	/**
+	 * @brief Checks whether all tasks of the job have finished.
+	 * @return True if the job is done.
+	 */
+	const bool isDone() const;
+
+	/**
+	 * @brief Blocks until all tasks of the job have finished.
+	 *
+	 * Exceptions thrown by the tasks (or the continuation the job represents) are rethrown here.
+	 *   A worker thread of a ThreadPool executes queued high and normal priority tasks of its pool
+	 *   while waiting, so jobs may be waited for inside tasks (e.g. runSystems() of worlds sharing
+	 *   one pool). Background and infinite tasks are never executed by a waiting worker.
+	 */
+	void wait();
+
+	/**
+	 * @brief Adds a continuation run after the job completes.
+	 * @param continuation The function run by the thread finishing the last task (or by the
+	 *        calling thread, if the job is already done).
+	 * @return The handle of the continuation, so that continuations can be chained.
+	 */
+	JobHandle then(std::function<void()> continuation);
+
+	/**
+	 * @brief Blocks until all given jobs have finished.
+	 * @param handles The handles of the jobs.
+	 *
+	 * All jobs are waited for, the first exception is rethrown afterwards.
+	 */
+	static void waitAll(std::vector<JobHandle> &handles);
+
+	/**
+	 * @brief Attaches the future of a task, so that wait() rethrows its exception.
+	 * @param future The future returned by ThreadPool::addTask().
+	 *
+	 * If the future is invalid (the pool did not accept the task), the task is completed here.
+	 *
+	 * @warning For internal use only.
+	 */
+	void attach(std::future<void> &&future);
+
+	/**
+	 * @brief Marks one task of the job as finished.
+	 *
+	 * The last call completes the job: waiting threads are woken up and continuations are run.
+	 *
+	 * @warning For internal use only.
+	 */
+	void completeTask() const;
+
+	/**
+	 * @brief Stores the exception rethrown by wait(), only the first one is kept.
+	 * @param exception The exception thrown by work of the job.
+	 *
+	 * @warning For internal use only.
+	 */
+	void setException(std::exception_ptr exception) const;
+
+private:
+	std::shared_ptr<impl::JobState> m_state;  /**< The state shared by all copies of the handle. */
+};
+
+}  // namespace ecs
@@ -1,8 +1,14 @@
 #pragma once
 
 #include "ComponentBuffer.h"
+#include "Prefab.h"
 #include "ThreadPool.h"
 #include "Interface.h"
+#include "System.h"
+#include "JobGraph.h"
+#include "Hierarchy.h"
+#include "SpatialIndex.h"
+#include "EventChannel.h"
 
 namespace ecs
 {
@@ -15,6 +21,9 @@ class Interface;  // predeclaration for friendship
  * Manager is the main interface provided for the user of this entity component system.
  * It provides methods for adding/checking/deleting entities and components.
  * 
+ * Every instance is an independent world with its own storage and entity id space, so many
+ *   worlds sharing the same component pool can live in one process.
+ * 
  * @tparam The component pool (types of components) used by all entities in the buffer.
  */
 template <typename TypeListT>
@@ -22,13 +31,54 @@ class Manager final
 {
 	friend class Interface;
 public:
+	/**
+	 * @brief Constructor
+	 * @param max_entity_count The maximum entity count possible to add to the buffer.
+	 * @param resource The memory resource used by entity and component storage.
+	 * 
+	 * Constructor reserves enough memory for all entities fitting in the max cap.
+	 * Passing e.g. std::pmr::monotonic_buffer_resource lets the whole world live in one arena.
+	 *   The resource has to outlive the Manager.
+	 * 
+	 * The created Manager owns a private ThreadPool with std::thread::hardware_concurrency() threads.
+	 */
+	explicit Manager(
+		const uint64 max_entity_count = uint64{1000},
+		std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+	/**
+	 * @brief Constructor
+	 * @param max_entity_count The maximum entity count possible to add to the buffer.
+	 * @param thread_pool The external ThreadPool executing systems of this Manager.
+	 * @param resource The memory resource used by entity and component storage.
+	 * 
+	 * The ThreadPool is not owned by the Manager, so it can be shared between many worlds. It has
+	 *   to outlive the Manager. Every Manager submits its systems to its own lane of the pool, so
+	 *   worlds sharing ThreadPool::shared() are served fairly (round-robin).
+	 */
+	Manager(
+		const uint64 max_entity_count,
+		ThreadPool &thread_pool,
+		std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
 	/**
 	 * @brief Gets an instance of the Manager class.
 	 * @param max_entity_count The maximum entity count possible to add to the buffer.
+	 * @param resource The memory resource used by entity and component storage.
 	 * @tparam TypeListT The component pool (types of components) used by all entities in the buffer.
 	 * @return The instance of the Manager singleton class.
+	 *
+	 * Both arguments are used only by the first call, which creates the instance.
+	 * This is a convenience global world, independent Managers can be constructed directly.
+	 */
+	static Manager<TypeListT> &getInstance(
+		const uint64 max_entity_count = uint64{1000},
+		std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+	/**
+	 * @brief Destructor, which returns the queue lane of this Manager to its ThreadPool.
 	 */
-	static Manager<TypeListT> &getInstance(const uint64 max_entity_count = uint64{1000});
+	~Manager();
 
 	Manager(const Manager<TypeListT> &copy) = delete;
 	Manager(Manager<TypeListT> &&source) = delete;
@@ -96,7 +146,7 @@ public:
 	 * If there is no such given TypeIndex, this method will throw an exception.
 	 */
 	template <uint16 TypeIndex>
-	std::vector<ComponentWrapper<meta::TypeAt<TypeIndex, TypeListT>>> &getComponentBucket();
+	ComponentBucket<meta::TypeAt<TypeIndex, TypeListT>> &getComponentBucket();
 
 	/**
 	 * @brief Gets the vector of wrapped (see explanation below) components.
@@ -123,7 +173,7 @@ public:
 	 * If there is no such given TypeIndex, this method will throw an exception.
 	 */
 	template <typename ComponentT>
-	std::vector<ComponentWrapper<ComponentT>> &getComponentBucket();
+	ComponentBucket<ComponentT> &getComponentBucket();
 
 	/**
 	 * @brief Checks if the given components exists in the buffer.
@@ -147,7 +197,13 @@ public:
 	 * @brief Gets the vector of entity ids.
 	 * @return The entity buffer.
 	 */
-	const std::vector<uint64> &getEntityBuffer() const;
+	const std::pmr::vector<uint64> &getEntityBuffer() const;
+
+	/**
+	 * @brief Gets the memory resource used by entity and component storage.
+	 * @return The memory resource.
+	 */
+	std::pmr::memory_resource *getMemoryResource() const noexcept;
 
 	/**
 	 * @brief Adds a new entity to the buffer.
@@ -161,6 +217,60 @@ public:
 	template <uint16 ComponentCount = uint16{64}>
 	const uint64 &addEntity(const uint64 components, const uint64 flags);
 
+	/**
+	 * @brief Adds many new entities sharing the same components and flags to the buffer.
+	 * @param count The number of added entities.
+	 * @param components The bitset of components, where every component has it's own bitwise position.
+	 * @param flags The bitset of flags attached to entities, where every flag has it's own bitwise position.
+	 * @return The id of the first added entity. Added entities have consecutive ids.
+	 *
+	 * Every buffer is reallocated at most once and all components are default constructed.
+	 * If the batch does not fit into the max cap, only the entities which fit are added.
+	 */
+	const uint64 addEntities(const uint64 count, const uint64 components, const uint64 flags);
+
+	/**
+	 * @brief Adds many new entities created from the prefab.
+	 * @param prefab The prefab holding components, their prototype values and flags.
+	 * @param count The number of added entities.
+	 * @return The id of the first added entity. Added entities have consecutive ids.
+	 *
+	 * Every component of the prefab is copied from its prototype value. Just like addEntities(),
+	 *   every buffer is reallocated at most once.
+	 */
+	const uint64 spawn(const Prefab<TypeListT> &prefab, const uint64 count);
+
+	/**
+	 * @brief Moves components from the caller's array to existing entities with consecutive ids.
+	 * @param first_entity_id The id of the first entity, e.g. returned by addEntities().
+	 * @param components The components of entities first_entity_id + 0..size-1, left moved-from.
+	 * @tparam ComponentT The type of the inserted components.
+	 *
+	 * This is the bulk insert of data produced elsewhere (e.g. a physics engine or a decoder).
+	 *   Components are moved into the bucket once, the array stays owned by the caller:
+	 *   @code
+	 *   const auto first = manager.addEntities(decoded.size(), 0u, 0u);
+	 *   manager.insertComponents<Position>(first, decoded);
+	 *   @endcode
+	 *
+	 * If entities first_entity_id + 0..size-1 are not stored one after another, or any of them
+	 *   already has ComponentT, this method throws std::invalid_argument.
+	 *
+	 * @see ComponentBuffer::insertComponents()
+	 */
+	template <typename ComponentT>
+	void insertComponents(const uint64 first_entity_id, Span<ComponentT> components);
+
+	/**
+	 * @brief Gets the strided view of all components of given type.
+	 * @tparam ComponentT The type of the viewed components.
+	 * @return The view over the bucket, valid until the bucket changes.
+	 *
+	 * @see ComponentBuffer::viewComponents()
+	 */
+	template <typename ComponentT>
+	StridedSpan<ComponentT> viewComponents();
+
 	/**
 	 * @brief Removes entities from the buffer.
 	 * @param entity_id The entity identifier (automatically attached to every created entity).
@@ -256,7 +366,7 @@ public:
 	 * @brief Gets the vector of entities' flags
 	 * @return The flag buffer.
 	 */
-	std::vector<uint64> &getFlagBuffer();
+	std::pmr::vector<uint64> &getFlagBuffer();
 
 	/**
 	 * @brief Applies passed function/functor/lambda (ECS system) to all entities matching required conditions.
@@ -385,43 +495,423 @@ public:
 	 */
 	void applySystem(void (*system)(Interface &interface));
 
+	/**
+	 * @brief Applies the system to all matching entities without waiting for it to finish.
+	 * @param system The function/functor/lambda (ECS system) working on components' data.
+	 * @param token The token skipping ranges not started before the cancellation (e.g. for
+	 *        optional work like LOD updates), the system itself may poll it too.
+	 * @return The handle of all ranges of the system, completed when the system is applied to
+	 *         every entity or the remaining ranges are skipped.
+	 *
+	 * Required components are deduced from the system's parameters, just like in registerSystem().
+	 *   The calling thread can do other work (I/O, rendering) in the meantime, chain continuations
+	 *   with JobHandle::then() or wait for many systems with JobHandle::waitAll(). If the thread
+	 *   pool is halted, ranges are applied by the calling thread before returning.
+	 *
+	 * @code
+	 * ecs::JobHandle job = manager.applySystemAsync([](const Velocity &vel, Position &pos) { pos.x += vel.x; });
+	 * // ... other work ...
+	 * job.wait();
+	 * @endcode
+	 *
+	 * @warning Entities must not be added or removed until the returned job is done.
+	 */
+	template <typename SystemT>
+	JobHandle applySystemAsync(SystemT &&system, const CancellationToken &token = CancellationToken());
+
+	/**
+	 * @brief Registers a system executed by every runSystems() call.
+	 * @param system The function/functor/lambda (ECS system) working on components' data.
+	 * @param name The name of the system used in diagnostics (e.g. race detector reports).
+	 * @param resources The resources read or written by the system, see getResources().
+	 * @return The index of the registered system.
+	 *
+	 * Unlike applySystem(), the required components are deduced from the system's parameters.
+	 *   Parameters taken by const reference are declared as read, the other ones as written.
+	 *   The first parameter can optionally be the Interface.
+	 *
+	 * @code
+	 * manager.registerSystem([](const Velocity &vel, Position &pos) { pos.x += vel.x; });
+	 * manager.registerSystem([](const Position &pos, Color &col) { col.r = pos.x > 0.f; });
+	 * manager.registerSystem([](const Velocity &vel) { std::cout << vel.x; });
+	 * manager.runSystems();
+	 * @endcode
+	 *
+	 * In the example above the second system has to wait for the first one (it reads Position,
+	 *   which is written by the first one), but the third system runs in parallel with the first.
+	 *   Systems accessing resources are ordered the same way by the declared resource access.
+	 */
+	template <typename SystemT>
+	const uint64 registerSystem(
+		SystemT &&system,
+		const std::string &name = "",
+		const ResourceAccess &resources = ResourceAccess());
+
+	/**
+	 * @brief Removes all registered systems.
+	 */
+	void clearSystems();
+
+	/**
+	 * @brief Executes all registered systems once (a frame).
+	 *
+	 * Systems are ordered by the registration order, but only where their component access
+	 *   conflicts (one of them writes a component accessed by the other). Systems without
+	 *   conflicts are executed at the same time by the ThreadPool, every one of them split into
+	 *   ranges of entities.
+	 *
+	 * All systems are submitted at once as a JobGraph, so a system starts as soon as the systems
+	 *   it conflicts with finish, without waiting for unrelated ones.
+	 */
+	void runSystems();
+
+	/**
+	 * @brief Reorders entities and all their components by values of the given component.
+	 * @param compare The comparator of two components (strict weak ordering).
+	 * @param mode The sorting algorithm, SortMode::Incremental is faster for nearly sorted data.
+	 * @tparam ComponentT The type of components used as the key.
+	 *
+	 * The bucket of ComponentT is sorted first, then the same permutation is applied to the
+	 *   entity ids, flags and component bitsets, and every other bucket follows the new entity
+	 *   order. Entities without ComponentT keep their relative order after the sorted ones.
+	 *   Systems then walk entities grouped by the key (e.g. spatial cell or material), which
+	 *   improves cache locality and branch prediction.
+	 *
+	 * @code
+	 * manager.sort<Position>([](const Position &lhs, const Position &rhs) { return cell(lhs) < cell(rhs); });
+	 * @endcode
+	 *
+	 * If there is no such component type in the pool, this method throws std::invalid_argument.
+	 *
+	 * @warning Entity indices change, so this method must not be called while systems run.
+	 */
+	template <typename ComponentT, typename CompareT>
+	void sort(CompareT compare, const SortMode mode = SortMode::Full);
+
+	/**
+	 * @brief Creates the owning group of component types iterated together by hot systems.
+	 * @tparam ComponentTs Types of components owned by the group.
+	 *
+	 * Entities having all components of the group are kept packed at the front of every owned
+	 *   bucket in identical order, see ComponentBuffer::group(). A component type can be owned by
+	 *   one group only, otherwise this method throws std::logic_error.
+	 */
+	template <typename... ComponentTs>
+	void group();
+
+	/**
+	 * @brief Applies the system to all entities of the owning group.
+	 * @param system The function/functor/lambda taking exactly the owned components.
+	 *
+	 * Parameters are deduced like in registerSystem() and have to match types of an existing group
+	 *   (in any order), otherwise std::invalid_argument is thrown. Owned buckets are walked in
+	 *   lockstep over contiguous arrays, without entity lookups or bitset checks.
+	 *
+	 * @code
+	 * manager.group<Position, Velocity>();
+	 * manager.applyGroup([](Position &pos, const Velocity &vel) { pos.x += vel.x; });
+	 * @endcode
+	 */
+	template <typename SystemT>
+	void applyGroup(SystemT &&system);
+
+	/**
+	 * @brief Aggregates values computed from components of all matching entities.
+	 * @param init The identity of combine (e.g. 0 for sums), every partial result starts with it.
+	 * @param map The function taking components by const reference and returning a value.
+	 * @param combine The associative function merging two values into one.
+	 * @return The combination of values of all entities having the components of map.
+	 *
+	 * Entities are split into ranges, one per thread of the ThreadPool, which compute partial
+	 *   results without sharing any state. Partial results are combined in the order of ranges,
+	 *   so the result does not depend on the scheduling. Single components and owning groups are
+	 *   walked directly over contiguous buckets, other queries go through the entity buffer.
+	 *
+	 * @code
+	 * float energy = manager.reduce(0.f, [](const Energy &e) { return e.value; }, std::plus<>());
+	 * @endcode
+	 */
+	template <typename ResultT, typename MapT, typename CombineT>
+	ResultT reduce(ResultT init, MapT &&map, CombineT &&combine);
+
+	/**
+	 * @brief Counts entities whose components pass the predicate.
+	 * @param predicate The function taking components by const reference and returning bool.
+	 * @return The number of matching entities.
+	 *
+	 * @see reduce()
+	 */
+	template <typename PredicateT>
+	const uint64 countIf(PredicateT &&predicate);
+
+	/**
+	 * @brief Finds the smallest value computed from components of matching entities.
+	 * @param map The function taking components by const reference and returning a comparable value.
+	 * @return The smallest value, std::nullopt if no entity matches.
+	 *
+	 * @see reduce()
+	 */
+	template <typename MapT>
+	auto min(MapT &&map);
+
+	/**
+	 * @brief Finds the largest value computed from components of matching entities.
+	 * @param map The function taking components by const reference and returning a comparable value.
+	 * @return The largest value, std::nullopt if no entity matches.
+	 *
+	 * @see reduce()
+	 */
+	template <typename MapT>
+	auto max(MapT &&map);
+
+	/**
+	 * @brief Gets the parent/child relationship between entities of this Manager.
+	 * @return The hierarchy, deleted entities are removed from it automatically.
+	 */
+	Hierarchy &getHierarchy() noexcept;
+
+	/**
+	 * @brief Gets the world-level resources of this Manager (e.g. time or configuration).
+	 * @return The resources, also reachable from systems by Interface::resource().
+	 *
+	 * Systems using resources should declare them in registerSystem(), so they are scheduled
+	 *   correctly. Resources must not be added or removed while systems run.
+	 */
+	Resources &getResources() noexcept;
+
+	/**
+	 * @brief Passes the component of every parent to its children (e.g. transform propagation).
+	 * @param function The function taking the child's component and the parent's one.
+	 * @tparam ComponentT The type of propagated components.
+	 *
+	 * Entities are visited in the depth-first order of the hierarchy, so every parent is updated
+	 *   before its children. Independent subtrees are processed at the same time by the ThreadPool.
+	 *   Entities without ComponentT (or with a parent without it) are skipped.
+	 *
+	 * The bucket of ComponentT is not reordered, so it stays in lockstep with the entity buffer
+	 *   after sort(). If its components already follow the depth-first order, they are matched to
+	 *   the hierarchy by one linear walk, otherwise by a lookup table built by every call.
+	 *
+	 * @code
+	 * manager.propagate<Transform>([](Transform &child, const Transform &parent) { child.world = parent.world * child.local; });
+	 * @endcode
+	 */
+	template <typename ComponentT, typename FunctionT>
+	void propagate(FunctionT &&function);
+
+	/**
+	 * @brief Rebuilds the spatial index from positions stored in the component.
+	 * @param index The rebuilt index.
+	 * @param position The function taking the component and returning SpatialIndex::Point.
+	 * @tparam ComponentT The type of the component holding positions.
+	 *
+	 * Every entity with ComponentT is indexed. The rebuild runs on the ThreadPool of this Manager,
+	 *   usually once per tick after movement systems.
+	 *
+	 * @warning Entities must not be added or removed during the rebuild.
+	 */
+	template <typename ComponentT, typename PositionT>
+	void updateSpatialIndex(SpatialIndex &index, PositionT &&position);
+
+	/**
+	 * @brief Registers the observer of added or removed components of given type.
+	 * @param event The observed kind of change.
+	 * @param observer The callback receiving ids of affected entities.
+	 * @tparam ComponentT The observed type of the component.
+	 * @return The id of the observer used by unobserve().
+	 *
+	 * Changes made by addComponent(), addEntity(), spawn(), deleteEntity() and the other
+	 *   structural methods are batched and delivered by flushObservers(), which is also called at
+	 *   the beginning of every runSystems().
+	 *
+	 * @see ComponentBuffer::observe()
+	 */
+	template <typename ComponentT>
+	const uint64 observe(const ComponentEvent event, ComponentObserver observer);
+
+	/**
+	 * @brief Removes the observer registered by observe().
+	 * @param observer_id The id of the observer.
+	 */
+	void unobserve(const uint64 observer_id);
+
+	/**
+	 * @brief Delivers all batched component changes to the observers.
+	 *
+	 * @see ComponentBuffer::flushObservers()
+	 */
+	void flushObservers();
+
+	/**
+	 * @brief Binds entity ranges of systems to NUMA nodes of the ThreadPool.
+	 * @param enabled True if ranges should be partitioned between nodes (false by default).
+	 *
+	 * Entity indices are split into one contiguous slice per node and ranges of every slice are
+	 *   preferably executed by workers pinned to that node (see ThreadPool::setAffinity()). The
+	 *   same slice is processed by the same socket every frame, so component pages first touched
+	 *   by its workers stay in local memory.
+	 */
+	void setNumaPartitioning(const bool enabled) noexcept;
+
+	/**
+	 * @brief Makes results of systems reproducible on every machine and for every thread count.
+	 * @param enabled True if the deterministic mode is used (false by default).
+	 * @param chunk_size The number of entities in every range of a system, has to be positive.
+	 *
+	 * In the deterministic mode:
+	 *   - entities are split into ranges of chunk_size entities instead of one range per thread, so
+	 *     reduce() and its variants combine the same partial results in the same order,
+	 *   - events of EventChannel instances with EventChannel::setOrdered() are merged in the order
+	 *     of systems and ranges instead of the order of workers,
+	 *   - deleted entities and components are erased instead of swapped with the last one, so the
+	 *     order of remaining entities does not depend on the order of deletions.
+	 *
+	 * Ranges are still executed at the same time, only the order-preserving deletion is O(n).
+	 *   If the chunk size is not positive, this method throws std::invalid_argument.
+	 */
+	void setDeterministic(const bool enabled, const uint64 chunk_size = defaultChunkSize);
+
+	/**
+	 * @brief Checks whether the deterministic mode is used.
+	 * @return True if setDeterministic() enabled it.
+	 */
+	const bool isDeterministic() const noexcept;
+
+#if ECS_RACE_DETECTOR
+	/**
+	 * @brief Gets the race detector validating component access of systems.
+	 * @return The race detector of the component buffer.
+	 */
+	debug::RaceDetector &getRaceDetector() noexcept;
+#endif
+
 private:
 	/**
-	 * @brief Constructor
-	 * @param max_entity_count The maximum entity count possible to add to the buffer.
-	 * 
-	 * Constructor reserves enough memory for all entities fitting in the max cap.
+	 * @brief Constructor taking ownership of the private ThreadPool.
 	 */
-	Manager(const uint64 max_entity_count = uint64{1000});
+	Manager(
+		const uint64 max_entity_count,
+		std::unique_ptr<ThreadPool> &&owned_thread_pool,
+		std::pmr::memory_resource *resource);
 
 	/**
 	 * @brief Convenience helper method used in addEntity().
 	 */
 	template <uint16 Index> void addEntityComponents(const uint64 components, const uint64 &entity_id);
 
+	/**
+	 * @brief Common implementation of addEntities() and spawn().
+	 */
+	const uint64 addEntitiesFrom(
+		const uint64 components,
+		const uint64 flags,
+		const meta::metautil::TupleOfTypes<TypeListT> &prototypes,
+		const uint64 count);
+
+	/**
+	 * @brief Convenience helper method used in addEntitiesFrom().
+	 */
+	template <std::size_t... Indices>
+	void addEntitiesComponents(
+		std::index_sequence<Indices...>,
+		const uint64 components,
+		const uint64 first_entity_id,
+		const uint64 count,
+		const meta::metautil::TupleOfTypes<TypeListT> &prototypes);
+
 	/**
 	 * @brief Convenience helper method getting components for use in applySystem()
 	 */
 	template <typename... ComponentListT> auto getMatchingComponentPack(const uint64 &entity_id);
 
+	/**
+	 * @brief Convenience helper methods used in registerSystem().
+	 */
+	template <typename SystemT, typename... ComponentArgs>
+	SystemRecord makeSystemRecord(SystemT &&system, meta::TypeList<Interface &, ComponentArgs...> *);
+	template <typename SystemT, typename... ComponentArgs>
+	SystemRecord makeSystemRecord(SystemT &&system, meta::TypeList<ComponentArgs...> *);
+
+	/**
+	 * @brief Convenience helper method used in applyGroup().
+	 */
+	template <typename SystemT, typename... ComponentArgs>
+	void applyGroupHelper(SystemT &&system, meta::TypeList<ComponentArgs...> *);
+
+	/**
+	 * @brief Convenience helper methods used in reduce() and its variants.
+	 */
+	template <typename ResultT, typename MapT, typename CombineT, typename... ComponentArgs>
+	ResultT reduceHelper(ResultT init, MapT &map, CombineT &combine, meta::TypeList<ComponentArgs...> *);
+	template <typename MapT, typename CompareT, typename... ComponentArgs>
+	auto extremeHelper(MapT &map, CompareT compare, meta::TypeList<ComponentArgs...> *);
+
+	/**
+	 * @brief Executes the system for every range, ranges are executed at the same time by the ThreadPool.
+	 * @param system The executed system.
+	 * @param ranges Ranges returned by splitRanges().
+	 */
+	void runRanges(SystemRecord system, const std::vector<std::pair<uint64, uint64>> &ranges);
+
 	/**
 	 * @brief Convenience helper method running code instead of applySystem()
 	 */
-	void applySystemHelper(std::function<void(const uint64, const uint64)> scheduler);
+	void applySystemHelper(SystemRecord system);
+
+	/**
+	 * @brief Splits the entities into ranges and adds them to the ThreadPool.
+	 * @param system The system executed for every range, it has to live until the ranges finish.
+	 * @param token The token skipping ranges not started before the cancellation.
+	 * @return The handle completed when all ranges finish.
+	 */
+	JobHandle dispatchRanges(const SystemRecord &system, const CancellationToken &token = CancellationToken());
+
+	/**
+	 * @brief Splits indices into ranges executed by separate tasks.
+	 * @param count The number of split indices (e.g. the entity count).
+	 * @return Pairs of the first and the one-past-last index of every range.
+	 */
+	std::vector<std::pair<uint64, uint64>> splitRanges(const uint64 count) const;
+
+	/**
+	 * @brief Gets the NUMA node preferred by the range.
+	 * @param index The index of the range returned by splitRanges().
+	 * @param count The number of ranges.
+	 * @return The node, TaskOptions::anyNode if partitioning is disabled.
+	 */
+	const unsigned rangeNode(const std::size_t index, const std::size_t count) const;
+
+	/**
+	 * @brief Executes the system for the range of entity indices.
+	 *
+	 * In the race detector mode the range is registered as a running system.
+	 */
+	void runRange(const SystemRecord &system, const uint64 start, const uint64 stop);
 
 private:
-	std::vector<uint64> m_entityBuffer;            /**< Stores all entities. */
-	std::vector<uint64> m_entityFlags;             /**< Stores flags of all entities. */
-	std::vector<uint64> m_entityComponents;        /**< Stores component bitsets of all entities. */
+	std::pmr::vector<uint64> m_entityBuffer;       /**< Stores all entities. */
+	std::pmr::vector<uint64> m_entityFlags;        /**< Stores flags of all entities. */
+	std::pmr::vector<uint64> m_entityComponents;   /**< Stores component bitsets of all entities. */
 
 	ComponentBuffer<TypeListT> m_componentBuffer;  /**< Stores all components. */
-	ThreadPool m_threadPool;
-
-	static uint64 m_nextEntityID;  /**< Used and incremented in every case when entity is added to the buffer */
+	std::unique_ptr<ThreadPool> m_ownedThreadPool; /**< The private ThreadPool, empty if an external one is used. */
+	ThreadPool *m_threadPool;                      /**< The ThreadPool executing systems. */
+	unsigned m_lane;                               /**< The queue lane of m_threadPool used by this Manager. */
+	bool m_numaPartitioning;                       /**< True if entity ranges are bound to NUMA nodes. */
+	bool m_deterministic;                          /**< True if results do not depend on the thread count. */
+	uint64 m_chunkSize;                            /**< The size of ranges in the deterministic mode. */
+	uint64 m_dispatchCount;                        /**< The number of dispatched systems, orders their events. */
+
+	std::vector<SystemRecord> m_systems;           /**< Systems registered for runSystems(). */
+	Hierarchy m_hierarchy;                         /**< The parent/child relationship between entities. */
+	Resources m_resources;                         /**< Resources stored once per Manager. */
+
+	uint64 m_nextEntityID;         /**< Used and incremented in every case when entity is added to the buffer */
 	uint16 m_flagCount;            /**< Number of existing entity flags. */
 	uint64 m_maxEntityCount;       /**< The max number of entities. */
 	uint64 m_entityCount;          /**< Number of currently existing entities. */
 	static constexpr const uint16 m_componentCount = meta::TypeListSize<TypeListT>;  /**< Number of component types. */
+	static constexpr const uint64 defaultChunkSize = uint64{1024};  /**< The default range size of the deterministic mode. */
 };
 
 }  // namespace ecs
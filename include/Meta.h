@@ -171,7 +171,7 @@ namespace meta
 		template <typename... Typepack>
 		struct TupleOfVectorsOfTypesImpl<TypeList<Typepack...>>
 		{
-			using Tuple = typename std::tuple<std::vector<Typepack> ...>;
+			using Tuple = typename std::tuple<std::pmr::vector<Typepack> ...>;
 		};
 
 		template <typename TypeListT>
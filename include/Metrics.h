@@ -0,0 +1,155 @@
+#pragma once
+
+#include "Root.h"
+
+namespace ecs
+{
+
+/**
+ * @brief The histogram of durations with logarithmic buckets (HDR-style).
+ *
+ * Every power of two is split into 4 linear sub-buckets, so any recorded value is reported with
+ *   at most 25% error, from nanoseconds to hours, in a fixed amount of memory.
+ */
+class LatencyHistogram
+{
+public:
+	static constexpr std::size_t bucketCount = 252u;  /**< The number of buckets covering all uint64 values. */
+
+	/**
+	 * @brief Gets the index of the bucket holding the value.
+	 * @param nanoseconds The recorded value.
+	 * @return The index of the bucket.
+	 */
+	static const std::size_t bucketOf(const uint64 nanoseconds) noexcept;
+
+	/**
+	 * @brief Gets the highest value held by the bucket.
+	 * @param bucket The index of the bucket.
+	 * @return The upper bound of the bucket in nanoseconds.
+	 */
+	static const uint64 upperBound(const std::size_t bucket) noexcept;
+
+	/**
+	 * @brief Adds the value to the histogram.
+	 * @param duration The recorded duration.
+	 */
+	void record(const std::chrono::nanoseconds duration) noexcept;
+
+	/**
+	 * @brief Adds all values of the other histogram.
+	 * @param other The other histogram.
+	 * @return This instance.
+	 */
+	LatencyHistogram &merge(const LatencyHistogram &other) noexcept;
+
+	/**
+	 * @brief Gets the number of recorded values.
+	 * @return The value count.
+	 */
+	const uint64 count() const noexcept;
+
+	/**
+	 * @brief Gets the value below which the given fraction of recorded values lies.
+	 * @param fraction The fraction in range [0, 1] (e.g. 0.99 for the 99th percentile).
+	 * @return The upper bound of the bucket holding the percentile, 0 if the histogram is empty.
+	 */
+	const std::chrono::nanoseconds percentile(const double fraction) const noexcept;
+
+	/**
+	 * @brief Gets the number of values in the bucket.
+	 * @param bucket The index of the bucket.
+	 * @return The value count.
+	 */
+	const uint64 bucketCountAt(const std::size_t bucket) const;
+
+	/**
+	 * @brief Sets the number of values in the bucket.
+	 * @param bucket The index of the bucket.
+	 * @param count The new value count.
+	 */
+	void setBucketCount(const std::size_t bucket, const uint64 count);
+
+private:
+	std::array<uint64, bucketCount> m_buckets{};  /**< The number of values in every bucket. */
+	uint64 m_count = 0u;  /**< The number of values in all buckets. */
+};
+
+/**
+ * @brief The snapshot of counters of one worker thread.
+ */
+struct WorkerMetrics
+{
+	uint64 tasksExecuted = 0u;  /**< The number of executed tasks. */
+	uint64 steals = 0u;  /**< The number of tasks taken from a queue of another NUMA node. */
+	uint64 tasksDropped = 0u;  /**< The number of tasks dropped because of their token or deadline. */
+	std::chrono::nanoseconds busyTime{0};  /**< The time spent executing tasks. */
+	std::chrono::nanoseconds idleTime{0};  /**< The time spent spinning or parked. */
+	LatencyHistogram queueLatency;  /**< The time from adding a task to the queue until its start. */
+	LatencyHistogram taskDuration;  /**< The execution time of tasks. */
+
+	/**
+	 * @brief Gets the fraction of measured time spent executing tasks.
+	 * @return The utilization in range [0, 1].
+	 */
+	const double utilization() const noexcept;
+};
+
+/**
+ * @brief The snapshot of counters of the whole ThreadPool, see ThreadPool::metrics().
+ */
+struct PoolMetrics
+{
+	std::vector<WorkerMetrics> workers;  /**< Counters of every worker thread. */
+	unsigned pendingTasks = 0u;  /**< The number of tasks waiting in queues. */
+	unsigned idleThreads = 0u;  /**< The number of parked threads. */
+
+	/**
+	 * @brief Sums the counters of all workers.
+	 * @return Counters of the pool as if it was one worker.
+	 */
+	WorkerMetrics total() const;
+};
+
+namespace impl
+{
+
+/**
+ * @brief Counters of one worker thread, written only by the worker.
+ *
+ * All counters are relaxed atomics, so a snapshot may be taken by another thread at any time.
+ */
+struct WorkerCounters
+{
+	std::atomic<uint64> tasksExecuted{0u};  /**< See WorkerMetrics::tasksExecuted. */
+	std::atomic<uint64> steals{0u};  /**< See WorkerMetrics::steals. */
+	std::atomic<uint64> tasksDropped{0u};  /**< See WorkerMetrics::tasksDropped. */
+	std::atomic<uint64> busyNanoseconds{0u};  /**< See WorkerMetrics::busyTime. */
+	std::atomic<uint64> idleNanoseconds{0u};  /**< See WorkerMetrics::idleTime. */
+	std::array<std::atomic<uint64>, LatencyHistogram::bucketCount> queueLatency{};  /**< See WorkerMetrics::queueLatency. */
+	std::array<std::atomic<uint64>, LatencyHistogram::bucketCount> taskDuration{};  /**< See WorkerMetrics::taskDuration. */
+
+	/**
+	 * @brief Adds the duration to the histogram.
+	 * @param histogram The queueLatency or taskDuration member.
+	 * @param duration The recorded duration.
+	 */
+	static void record(
+		std::array<std::atomic<uint64>, LatencyHistogram::bucketCount> &histogram,
+		const std::chrono::nanoseconds duration) noexcept;
+
+	/**
+	 * @brief Copies all counters.
+	 * @return The snapshot of counters.
+	 */
+	WorkerMetrics snapshot() const;
+
+	/**
+	 * @brief Sets all counters to zero.
+	 */
+	void reset() noexcept;
+};
+
+}  // namespace impl
+
+}  // namespace ecs
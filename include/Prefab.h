@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Meta.h"
+
+namespace ecs
+{
+
+/**
+ * @brief Class predeclaration.
+ * @tparam TypeListT List of component types used by the Manager.
+ */
+template <typename TypeListT>
+class Prefab;
+
+/**
+ * @brief The template of an entity used for spawning many identical entities at once.
+ * @tparam Typepack Pack of component types used by the Manager.
+ *
+ * Prefab holds a prototype value of every component it contains, the component bitset and the
+ *   flags given to spawned entities.
+ *
+ * Example:
+ * @code
+ * using CPool = ecs::meta::ComponentPool<Position, Velocity, Color>;
+ * ecs::Prefab<CPool> particle(F_ALIVE);
+ * particle.set(Position{0.f, 0.f}).set(Velocity{1.f, 0.f});
+ * manager.spawn(particle, 50000);  // 50k entities with copies of Position and Velocity
+ * @endcode
+ */
+template <typename... Typepack>
+class Prefab<meta::TypeList<Typepack...>>
+{
+	using m_tPool = meta::TypeList<Typepack...>;
+public:
+	/**
+	 * @brief The constructor.
+	 * @param flags The bitset of flags attached to every spawned entity.
+	 */
+	explicit Prefab(const uint64 flags = uint64{0});
+
+	/**
+	 * @brief Adds a component to the prefab or replaces its prototype value.
+	 * @param component The prototype value copied to every spawned entity.
+	 * @tparam ComponentT The type of the component.
+	 * @return This instance, so that calls can be chained.
+	 */
+	template <typename ComponentT>
+	Prefab &set(const ComponentT &component);
+
+	/**
+	 * @brief Gets the prototype value of the component.
+	 * @tparam ComponentT The type of the component.
+	 * @return The prototype value (default constructed if it has never been set).
+	 */
+	template <typename ComponentT>
+	const ComponentT &get() const;
+
+	/**
+	 * @brief Gets all prototype values.
+	 * @return The tuple of prototype values, ordered like the component pool.
+	 */
+	const std::tuple<Typepack...> &prototypes() const noexcept;
+
+	/**
+	 * @brief Gets the component bitset of spawned entities.
+	 * @return The component bitset.
+	 */
+	const uint64 &components() const noexcept;
+
+	/**
+	 * @brief Gets the flag bitset of spawned entities.
+	 * @return The flag bitset.
+	 */
+	const uint64 &flags() const noexcept;
+
+private:
+	std::tuple<Typepack...> m_prototypes;  /**< Prototype values of all components. */
+	uint64 m_components;                   /**< Bitset of components used by the prefab. */
+	uint64 m_flags;                        /**< Bitset of flags attached to spawned entities. */
+};
+
+}  // namespace ecs
+
+#include "../src/Prefab.inl"
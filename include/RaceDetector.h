@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Util.h"
+
+// Checked build mode validating component access of systems. Enable with -DECS_RACE_DETECTOR=1
+//   (or the ECS_RACE_DETECTOR CMake option). When disabled, all hooks compile to nothing.
+#ifndef ECS_RACE_DETECTOR
+	#define ECS_RACE_DETECTOR 0
+#endif
+
+#if ECS_RACE_DETECTOR
+	#define RACE_DETECTOR_RECORD(detector, component, access) ((detector).recordAccess((component), (access)))
+#else
+	#define RACE_DETECTOR_RECORD(detector, component, access) ((void)0)
+#endif
+
+namespace ecs
+{
+namespace debug
+{
+
+/**
+ * @brief Type of access to a component bucket.
+ */
+enum class Access
+{
+	Read,
+	Write
+};
+
+/**
+ * @brief Class detecting data races on component buckets.
+ *
+ * Every thread executing a system registers the system's declared component access with
+ *   beginSystem(). The detector then reports:
+ *   1) overlapping writes or read/write conflicts between different systems running at the same
+ *      time on different threads;
+ *   2) bucket accesses not declared by the system running on the accessing thread;
+ *   3) accesses from outside of systems conflicting with any running system.
+ *
+ * Every report contains the thread id, the access type and the name of the system. Reports are
+ *   printed to std::cerr and stored (repeated ones only once), so they can be checked with reports().
+ *
+ * @note The detector locks a mutex on every recorded access, it is meant for debug builds only.
+ */
+class RaceDetector
+{
+public:
+	/**
+	 * @brief The constructor.
+	 * @param component_names Names of components, ordered like the component pool.
+	 */
+	explicit RaceDetector(std::vector<std::string> component_names = {});
+
+	/**
+	 * @brief Marks the calling thread as executing the system.
+	 * @param system The identity of the system, ranges of one system never conflict with each other.
+	 * @param name The name of the system used in reports.
+	 * @param reads The bitset of components declared as read.
+	 * @param writes The bitset of components declared as written.
+	 */
+	void beginSystem(const void *system, const std::string &name, const uint64 reads, const uint64 writes);
+
+	/**
+	 * @brief Marks the calling thread as no longer executing the system of the last beginSystem().
+	 *
+	 * Systems started by a waiting thread nest, the thread returns to the system it waited in.
+	 */
+	void endSystem();
+
+	/**
+	 * @brief Records the access of the calling thread to the component bucket.
+	 * @param component The index of the component type in the pool.
+	 * @param access The type of the access.
+	 */
+	void recordAccess(const uint16 component, const Access access);
+
+	/**
+	 * @brief Gets all reports collected so far.
+	 * @return The copy of the reports.
+	 */
+	std::vector<std::string> reports() const;
+
+	/**
+	 * @brief Removes all collected reports.
+	 */
+	void clearReports();
+
+private:
+	/**
+	 * @brief The system executed by a thread.
+	 */
+	struct Region
+	{
+		const void *system;  /**< The identity of the system. */
+		std::string name;    /**< The name of the system. */
+		uint64 reads;        /**< The bitset of components declared as read. */
+		uint64 writes;       /**< The bitset of components declared as written. */
+	};
+
+	/**
+	 * @brief Builds a readable list of components from the bitset.
+	 */
+	std::string componentNames(const uint64 bitset) const;
+
+	/**
+	 * @brief Stores and prints the report. Has to be called with m_mutex locked.
+	 */
+	void report(const std::string &message);
+
+private:
+	std::vector<std::string> m_componentNames;  /**< Names of components used in reports. */
+	std::unordered_map<std::thread::id, std::vector<Region>> m_regions;  /**< Stacks of systems executed by threads right now. */
+	std::vector<std::string> m_reports;  /**< All collected reports. */
+	std::unordered_set<std::string> m_reported;  /**< Already collected reports, used to skip repetitions. */
+	mutable std::mutex m_mutex;  /**< The global mutex of RaceDetector. */
+};
+
+}  // namespace debug
+}  // namespace ecs
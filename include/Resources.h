@@ -0,0 +1,151 @@
+#pragma once
+
+#include "Root.h"
+
+namespace ecs
+{
+
+namespace impl
+{
+
+/**
+ * @brief Assigns the next free resource index.
+ * @return The index, unique in the whole process.
+ *
+ * @warning For internal use only.
+ */
+std::size_t nextResourceIndex() noexcept;
+
+/**
+ * @brief Gets the index of the resource type, used to find the resource in O(1).
+ * @tparam ResourceT The type of the resource.
+ * @return The index assigned on the first call for the type.
+ */
+template <typename ResourceT>
+std::size_t resourceIndex() noexcept
+{
+	static const std::size_t index = nextResourceIndex();
+	return index;
+}
+
+}  // namespace impl
+
+/**
+ * @brief The world-level storage of resources, at most one object of every type.
+ *
+ * Resources hold global state which is not bound to entities, e.g. time, configuration or random
+ *   number generators. Every type gets a process-wide index on first use, so a resource is found
+ *   by indexing a vector instead of searching a map.
+ *
+ * @code
+ * manager.getResources().emplace<Time>(Time{0.016f});
+ * manager.registerSystem([&manager](Position &pos) { pos.x += manager.getResources().get<Time>().delta; },
+ *     "move", ecs::ResourceAccess().reads<Time>());
+ * @endcode
+ *
+ * @note Resources may be read by many threads at the same time, but emplace() and remove() must
+ *       not be called while systems run.
+ */
+class Resources
+{
+public:
+	/**
+	 * @brief Creates the resource, replacing the existing one of the same type.
+	 * @param args Arguments passed to the constructor of the resource.
+	 * @tparam ResourceT The type of the resource.
+	 * @return The created resource.
+	 */
+	template <typename ResourceT, typename... Args>
+	ResourceT &emplace(Args &&...args);
+
+	/**
+	 * @brief Gets the resource of given type.
+	 * @tparam ResourceT The type of the resource.
+	 * @return The resource.
+	 *
+	 * If there is no such resource, this method throws std::out_of_range.
+	 */
+	template <typename ResourceT>
+	ResourceT &get();
+
+	/**
+	 * @brief Gets the resource of given type.
+	 * @tparam ResourceT The type of the resource.
+	 * @return The resource.
+	 *
+	 * This is a const version of this method provided for convenience.
+	 */
+	template <typename ResourceT>
+	const ResourceT &get() const;
+
+	/**
+	 * @brief Gets the resource of given type if it exists.
+	 * @tparam ResourceT The type of the resource.
+	 * @return The pointer to the resource, nullptr if there is no such resource.
+	 */
+	template <typename ResourceT>
+	ResourceT *find() const noexcept;
+
+	/**
+	 * @brief Removes the resource of given type, if it exists.
+	 * @tparam ResourceT The type of the resource.
+	 */
+	template <typename ResourceT>
+	void remove() noexcept;
+
+	/**
+	 * @brief Removes all resources.
+	 */
+	void clear() noexcept;
+
+private:
+	std::vector<std::shared_ptr<void>> m_resources;  /**< Resources indexed by impl::resourceIndex(). */
+};
+
+/**
+ * @brief The declaration of resources read or written by a system, used to schedule systems.
+ *
+ * Systems writing a resource are ordered with all systems accessing it, just like with components.
+ */
+class ResourceAccess
+{
+public:
+	/**
+	 * @brief Declares resources as read.
+	 * @tparam ResourceTs Types of read resources.
+	 * @return This instance.
+	 */
+	template <typename... ResourceTs>
+	ResourceAccess &reads();
+
+	/**
+	 * @brief Declares resources as written.
+	 * @tparam ResourceTs Types of written resources.
+	 * @return This instance.
+	 */
+	template <typename... ResourceTs>
+	ResourceAccess &writes();
+
+	/**
+	 * @brief Checks whether two systems cannot run at the same time because of resources.
+	 * @param other The declaration of the other system.
+	 * @return True if any of the systems writes a resource accessed by the other one.
+	 */
+	const bool conflictsWith(const ResourceAccess &other) const noexcept;
+
+private:
+	/**
+	 * @brief Checks whether the sorted lists of indices share any index.
+	 *
+	 * @warning For internal use only.
+	 */
+	static const bool intersects(const std::vector<std::size_t> &lhs, const std::vector<std::size_t> &rhs) noexcept;
+
+private:
+	std::vector<std::size_t> m_reads;   /**< Sorted indices of read resources. */
+	std::vector<std::size_t> m_writes;  /**< Sorted indices of written resources. */
+};
+
+}  // namespace ecs
+
+#include "../src/Resources.inl"
@@ -21,10 +21,13 @@
 #include <sstream>
 #include <queue>
 #include <vector>
+#include <array>
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <functional>
+#include <utility>
 #include <bitset>
 
 #include <cstdlib>
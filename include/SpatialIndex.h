@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Root.h"
+#include "Util.h"
+#include "ThreadPool.h"
+#include "JobGraph.h"
+
+namespace ecs
+{
+
+/**
+ * @brief The uniform grid of entity positions answering radius and box queries.
+ *
+ * Positions are hashed by their grid cell and sorted into contiguous cell buckets with a
+ *   parallel counting sort, so a rebuild is O(n) in time and memory and every query only visits
+ *   the cells it overlaps. The index is meant to be rebuilt every tick, see
+ *   Manager::updateSpatialIndex():
+ *
+ * @code
+ * ecs::SpatialIndex grid(4.f);  // the cell size should be close to typical query radii
+ * manager.updateSpatialIndex<Position>(grid, [](const Position &pos) { return ecs::SpatialIndex::Point{pos.x, pos.y, 0.f}; });
+ * std::vector<ecs::uint64> buffer;
+ * for(auto id : grid.queryRadius({0.f, 0.f, 0.f}, 10.f, buffer)) { ... }
+ * @endcode
+ *
+ * Queries are const, so any number of threads may query the index at the same time.
+ */
+class SpatialIndex
+{
+public:
+	using Point = std::array<float, 3>;  /**< The position, 2D users can leave the last coordinate 0. */
+
+	/**
+	 * @brief The constructor.
+	 * @param cell_size The edge of a grid cell, has to be positive.
+	 *
+	 * If the cell size is not positive, this constructor throws std::invalid_argument.
+	 */
+	explicit SpatialIndex(const float cell_size = 1.f);
+
+	/**
+	 * @brief Replaces all indexed positions.
+	 * @param pool The pool executing the build, ranges of positions are processed at the same time.
+	 * @param count The number of indexed entities.
+	 * @param fetch The function returning the entity id and position at the index in [0, count),
+	 *        called once per index, possibly by many threads at the same time.
+	 * @param options The options of added tasks (e.g. the lane).
+	 */
+	void build(
+		ThreadPool &pool,
+		const std::size_t count,
+		const std::function<std::pair<uint64, Point>(const std::size_t index)> &fetch,
+		const TaskOptions &options = TaskOptions{});
+
+	/**
+	 * @brief Finds all entities within the radius.
+	 * @param center The center of the sphere.
+	 * @param radius The radius of the sphere.
+	 * @param result The buffer receiving entity ids, cleared first (reused between queries).
+	 * @return The span of found ids, valid until the buffer changes. Empty for a negative radius
+	 *         or coordinates which are not finite.
+	 */
+	Span<const uint64> queryRadius(const Point &center, const float radius, std::vector<uint64> &result) const;
+
+	/**
+	 * @brief Finds all entities inside the axis-aligned box.
+	 * @param min The corner with the lowest coordinates.
+	 * @param max The corner with the highest coordinates.
+	 * @param result The buffer receiving entity ids, cleared first (reused between queries).
+	 * @return The span of found ids, valid until the buffer changes. Empty for an inverted box
+	 *         or coordinates which are not finite.
+	 */
+	Span<const uint64> queryBox(const Point &min, const Point &max, std::vector<uint64> &result) const;
+
+	/**
+	 * @brief Gets the number of indexed entities.
+	 * @return The entity count.
+	 */
+	const std::size_t size() const noexcept;
+
+	/**
+	 * @brief Gets the edge of a grid cell.
+	 * @return The cell size.
+	 */
+	const float cellSize() const noexcept;
+
+private:
+	using Cell = std::array<int64, 3>;  /**< Integer coordinates of a grid cell. */
+
+	/**
+	 * @brief Gets the cell containing the position.
+	 *
+	 * @warning For internal use only.
+	 */
+	const Cell cellOf(const Point &point) const noexcept;
+
+	/**
+	 * @brief Gets the bucket of the hash table holding the cell.
+	 *
+	 * @warning For internal use only.
+	 */
+	const std::size_t bucketOf(const Cell &cell) const noexcept;
+
+	/**
+	 * @brief Adds entities of all buckets overlapping the box and passing the test to the result.
+	 * @param min The corner with the lowest coordinates.
+	 * @param max The corner with the highest coordinates.
+	 * @param test The exact test of a position.
+	 * @param result The buffer receiving entity ids.
+	 *
+	 * @warning For internal use only.
+	 */
+	template <typename TestT>
+	void collect(const Point &min, const Point &max, TestT test, std::vector<uint64> &result) const;
+
+private:
+	float m_cellSize;                        /**< The edge of a grid cell. */
+	float m_inverseCellSize;                 /**< 1 / m_cellSize. */
+	std::size_t m_bucketMask = 0u;           /**< The number of buckets minus one (a power of two). */
+	std::vector<std::size_t> m_bucketStart;  /**< The first entry of every bucket, with the end appended. */
+	std::vector<uint64> m_entities;          /**< Entity ids sorted by buckets. */
+	std::vector<Point> m_points;             /**< Positions sorted by buckets. */
+};
+
+}  // namespace ecs
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Meta.h"
+#include "Interface.h"
+#include "Resources.h"
+
+namespace ecs
+{
+namespace meta
+{
+	// ############################################################################################
+	// Implementation of SystemArguments
+
+	// 1) lambdas and functors - deduced from their operator()
+	template <typename SystemT>
+	struct SystemArgumentsImpl : SystemArgumentsImpl<decltype(&SystemT::operator())> {};
+	// 2) function pointers
+	template <typename ReturnT, typename... Args>
+	struct SystemArgumentsImpl<ReturnT (*)(Args...)>
+	{
+		using Arguments = TypeList<Args...>;
+	};
+	// 3) mutable lambdas and non-const operator()
+	template <typename ClassT, typename ReturnT, typename... Args>
+	struct SystemArgumentsImpl<ReturnT (ClassT::*)(Args...)>
+	{
+		using Arguments = TypeList<Args...>;
+	};
+	// 4) lambdas, std::function and const operator()
+	template <typename ClassT, typename ReturnT, typename... Args>
+	struct SystemArgumentsImpl<ReturnT (ClassT::*)(Args...) const>
+	{
+		using Arguments = TypeList<Args...>;
+	};
+
+	template <typename SystemT>
+	using SystemArguments = typename SystemArgumentsImpl<std::decay_t<SystemT>>::Arguments;
+
+	// Example:
+	// SystemArguments<void(*)(const Position &, Velocity &)> => TypeList<const Position &, Velocity &>
+
+	// ############################################################################################
+	// Implementation of ReadBit and WriteBit
+
+	// ArgumentT is a parameter of the system, const references are reads, other references are writes
+	template <typename ArgumentT, typename TypeListT>
+	constexpr uint64 ComponentBit = uint64{1} << IndexOf<std::decay_t<ArgumentT>, TypeListT>;
+
+	template <typename ArgumentT, typename TypeListT>
+	constexpr uint64 ReadBit =
+		(std::is_const<std::remove_reference_t<ArgumentT>>::value) ? ComponentBit<ArgumentT, TypeListT> : uint64{0};
+
+	template <typename ArgumentT, typename TypeListT>
+	constexpr uint64 WriteBit =
+		(std::is_const<std::remove_reference_t<ArgumentT>>::value) ? uint64{0} : ComponentBit<ArgumentT, TypeListT>;
+}  // namespace meta
+
+/**
+ * @brief Record of a system registered in the Manager.
+ *
+ * The component access of the system is derived from its parameters - const references are
+ *   reads, non-const references are writes. Resources are declared explicitly at registration.
+ */
+struct SystemRecord
+{
+	uint64 reads;   /**< The bitset of components read by the system. */
+	uint64 writes;  /**< The bitset of components written by the system. */
+	std::function<void(const uint64, const uint64)> execute;  /**< Runs the system for the range of entity indices. */
+	std::string name;  /**< The name of the system used in diagnostics. */
+	ResourceAccess resources = ResourceAccess();  /**< Resources read or written by the system. */
+	uint64 order = uint64{0};  /**< The dispatch order of the system, orders events of EventChannel. */
+
+	/**
+	 * @brief Checks whether two systems cannot run at the same time.
+	 * @param other The other system.
+	 * @return True if any of the systems writes a component or resource accessed by the other one.
+	 */
+	const bool conflictsWith(const SystemRecord &other) const noexcept;
+};
+
+}  // namespace ecs
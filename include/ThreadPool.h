@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Root.h"
+#include "Topology.h"
+#include "Metrics.h"
+#include "Cancellation.h"
 
 #define NODISCARD_REASON "The returned value is not used. Calling this method is unnecessary."
 #define NDMESSAGE [[nodiscard(NODISCARD_REASON)]]
@@ -8,6 +11,8 @@
 namespace ecs
 {
 
+class ThreadPool;  // predeclaration for WorkerContext
+
 namespace impl
 {
 
@@ -88,6 +93,228 @@ private:
 	std::mutex m_mutex;		/**< The global mutex of SafeQueue. */
 };
 
+/**
+ * @brief Class representing thread-safe queue split into priority levels and lanes.
+ * @tparam T The type of objects/values held by LaneQueue.
+ *
+ * Values of a higher level (lower index) are always removed first. Within a level, every producer
+ *   (for example a Manager) pushes to its own lane, so a producer adding many values at once
+ *   cannot starve the others - consecutive pop() calls take values from consecutive non-empty
+ *   lanes. With a single lane and level LaneQueue behaves like SafeQueue.
+ */
+template <typename T>
+class LaneQueue
+{
+public:
+	static constexpr unsigned levelCount = 3u;  /**< The number of priority levels. */
+
+	/**
+	 * @brief Adds a new value to the given lane.
+	 * @param value The new value.
+	 * @param lane The index of the lane, missing lanes are created.
+	 * @param level The priority level, 0 is the highest one.
+	 * @return True if pushed successfully, false otherwise.
+	 */
+	const bool push(const T &value, const unsigned lane = 0u, const unsigned level = 1u);
+
+	/**
+	 * @brief Adds many values to the given lane under one lock.
+	 * @param first The iterator to the first new value.
+	 * @param last The iterator past the last new value.
+	 * @param lane The index of the lane, missing lanes are created.
+	 * @param level The priority level, 0 is the highest one.
+	 * @return True if pushed successfully, false otherwise.
+	 */
+	template <typename Iterator>
+	const bool push(Iterator first, Iterator last, const unsigned lane = 0u, const unsigned level = 1u);
+
+	/**
+	 * @brief Removes the first value from the next non-empty lane of the highest non-empty level.
+	 * @param value The value removed from the queue (it is an output result).
+	 * @return True if removed an element successfully, false otherwise.
+	 */
+	const bool pop(T &value);
+
+	/**
+	 * @brief Removes the first value from the next non-empty lane of the given level.
+	 * @param value The value removed from the queue (it is an output result).
+	 * @param level The priority level.
+	 * @return True if removed an element successfully, false otherwise.
+	 */
+	const bool pop(T &value, const unsigned level);
+
+	/**
+	 * @brief Removes the first value of the next lane of the given level, whose first value is accepted.
+	 * @param value The value removed from the queue (it is an output result).
+	 * @param level The priority level.
+	 * @param accept The predicate checking the first value of a lane.
+	 * @return True if removed an element successfully, false if no lane starts with an accepted value.
+	 */
+	template <typename PredicateT>
+	const bool popIf(T &value, const unsigned level, PredicateT accept);
+
+	/**
+	 * @brief Checks if all lanes are empty.
+	 * @return True if empty, false otherwise.
+	 */
+	const bool empty();
+
+	/**
+	 * @brief Checks without locking if the level is empty.
+	 * @param level The priority level.
+	 * @return True if empty, false otherwise. The result may be outdated when it is returned.
+	 */
+	const bool empty(const unsigned level) const noexcept;
+
+private:
+	/**
+	 * @brief Lanes of one priority level.
+	 */
+	struct Level
+	{
+		std::vector<std::queue<T>> lanes;  /**< The containers holding values of every lane. */
+		std::size_t cursor = 0u;           /**< The index of the lane served by the next pop(). */
+	};
+
+	std::array<Level, levelCount> m_levels;  /**< All priority levels. */
+	std::array<std::atomic<std::size_t>, levelCount> m_sizes{};  /**< The number of values in every level. */
+	std::mutex m_mutex;                  /**< The global mutex of LaneQueue. */
+};
+
+/**
+ * @brief Hints the CPU that the calling thread is busy-waiting (e.g. the pause instruction).
+ */
+inline void cpuRelax() noexcept
+{
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	asm volatile("yield");
+#endif
+}
+
+}  // namespace impl
+
+/**
+ * @brief The behaviour of idle worker threads of the ThreadPool.
+ *
+ * A thread which finds the queue empty spins spinCount times (with the pause instruction), then
+ *   yields its time slice yieldCount times and only then parks on the condition variable. Parked
+ *   threads have to be woken up by the kernel, which takes tens of microseconds, spinning threads
+ *   pick up a new task almost immediately but keep their CPU busy.
+ */
+struct WaitPolicy
+{
+	unsigned spinCount = 0u;   /**< The number of pause loops before yielding. */
+	unsigned yieldCount = 0u;  /**< The number of yields before parking. */
+
+	/**
+	 * @brief Gets the policy parking idle threads immediately (default).
+	 * @return The policy.
+	 */
+	static constexpr WaitPolicy blocking() noexcept { return WaitPolicy{0u, 0u}; }
+
+	/**
+	 * @brief Gets the policy spinning for a few microseconds before parking.
+	 * @return The policy.
+	 */
+	static constexpr WaitPolicy balanced() noexcept { return WaitPolicy{4096u, 64u}; }
+};
+
+/**
+ * @brief Priority levels of tasks added to the ThreadPool.
+ */
+enum class TaskPriority : unsigned
+{
+	High = 0u,       /**< Latency-critical tasks, executed before all other ones. */
+	Normal = 1u,     /**< Tasks of systems and tasks added without options. */
+	Background = 2u  /**< Long work (e.g. saving snapshots), limited by setBackgroundThreadLimit(). */
+};
+
+/**
+ * @brief Scheduling of periodic tasks, see ThreadPool::addPeriodicTask().
+ */
+enum class PeriodicMode
+{
+	FixedRate,  /**< Runs start every period (ticks are skipped while the previous run is in progress). */
+	FixedDelay  /**< The next run starts one period after the previous one finishes. */
+};
+
+/**
+ * @brief Additional options of a task added to the ThreadPool.
+ */
+struct TaskOptions
+{
+	static constexpr unsigned anyNode = ~0u;  /**< The node value of tasks executed by any thread. */
+
+	unsigned lane = 0u;  /**< The queue lane of the task, see ThreadPool::createLane(). */
+	unsigned node = anyNode;  /**< The NUMA node preferred for execution, see ThreadPool::setAffinity(). */
+	TaskPriority priority = TaskPriority::Normal;  /**< The priority level of the task. */
+	CancellationToken token;  /**< The queued task is dropped without running once the token is cancelled. */
+	std::chrono::steady_clock::time_point deadline{};  /**< The queued task is dropped after this time, the default value means no deadline. */
+
+	/**
+	 * @brief Checks whether tasks with these options should be dropped instead of running.
+	 * @return True if the token is cancelled or the deadline has passed.
+	 */
+	const bool expired() const;
+};
+
+namespace impl
+{
+
+/**
+ * @brief The task waiting in the queue of the ThreadPool.
+ */
+struct Task
+{
+	/**
+	 * @brief The constructor of the task.
+	 * @param callable The callable object wrapped by the task.
+	 */
+	template <typename Callable>
+	explicit Task(Callable &&callable) : function(std::forward<Callable>(callable)) { }
+
+	std::function<void(const int)> function;  /**< The function executed by a thread. */
+	std::chrono::steady_clock::time_point enqueueTime;  /**< The time of adding to the queue, set if metrics are enabled. */
+	bool stolen = false;  /**< True if taken by a pinned thread from the queue of another node. */
+	CancellationToken token;  /**< See TaskOptions::token. */
+	std::chrono::steady_clock::time_point deadline;  /**< See TaskOptions::deadline. */
+	bool infinite = false;  /**< True for tasks of addInfiniteTask(), which never return on their own. */
+
+	/**
+	 * @brief Checks whether the task should be dropped instead of running.
+	 * @return True if the token is cancelled or the deadline has passed.
+	 */
+	const bool expired() const;
+};
+
+/**
+ * @brief The task scheduled by the timer thread of the ThreadPool.
+ */
+struct Timer
+{
+	uint64 id = 0u;  /**< The identifier returned to the user. */
+	std::function<void(const int)> func;  /**< The executed function. */
+	std::chrono::steady_clock::duration period{};  /**< The period of periodic tasks. */
+	bool periodic = false;  /**< False for delayed tasks, which run once. */
+	PeriodicMode mode = PeriodicMode::FixedRate;  /**< The scheduling of periodic tasks. */
+	TaskOptions options;  /**< The options of the task added to the queue on every run. */
+	std::atomic<bool> running{false};  /**< True if a run is queued or in progress. */
+	std::atomic<bool> cancelled{false};  /**< True if the timer has been cancelled. */
+};
+
+/**
+ * @brief The identity of the calling worker thread, see ThreadPool::currentWorkerIndex().
+ */
+struct WorkerContext
+{
+	ThreadPool *pool = nullptr;  /**< The pool owning the thread, nullptr outside worker threads. */
+	int index = -1;  /**< The index of the thread in the pool. */
+	std::atomic<unsigned> *node = nullptr;  /**< The node of the thread, see ThreadPool::setAffinity(). */
+	WorkerCounters *counters = nullptr;  /**< The metrics of the thread. */
+};
+
 }  // namespace impl
 
 /**
@@ -96,17 +323,28 @@ private:
 class ThreadPool
 {
 public:
+	using TimerID = uint64;  /**< The identifier of a delayed or periodic task. */
+
 	/**
 	 * @brief The constructor of the ThreadPool class.
 	 * @param thread_count The number of created threads.
+	 * @param resource The memory resource used for task storage.
 	 * 
 	 * By default, thread count is set to minimal logical value, which is 2. To unleash full power
 	 *   of multithreading, check your hardware capabilities and pass the maximal value.
 	 * @code
 	 * std::size_t thcount = std::thread::hardware_concurrency
 	 * @endcode
+	 *
+	 * Queued tasks and their shared states are allocated from the resource. Tasks are created and
+	 *   destroyed from different threads, so the resource has to be thread-safe (for example
+	 *   std::pmr::synchronized_pool_resource) and has to outlive the pool.
+	 *
+	 * The number of created threads is limited by the process-wide limit, see setGlobalThreadLimit().
 	 */
-	ThreadPool(const unsigned thread_count = 2u);
+	ThreadPool(
+		const unsigned thread_count = 2u,
+		std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
 	ThreadPool(const ThreadPool &) = delete;			/**< Deleted copy constructor. */
     ThreadPool(ThreadPool &&) = delete;					/**< Deleted move constructor. */
@@ -114,6 +352,32 @@ public:
     ThreadPool &operator=(ThreadPool &&) = delete;		/**< Deleted move assignment. */
 	virtual ~ThreadPool();	/**< The virtual destructor, which calls halt(true) and haltInfinite(). */
 
+	/**
+	 * @brief Gets the process-wide ThreadPool.
+	 * @return The shared ThreadPool instance.
+	 *
+	 * The pool is created by the first call with std::thread::hardware_concurrency() threads
+	 *   (bounded by the global thread limit). Passing it to every Manager prevents oversubscription
+	 *   of the machine when many worlds exist at once.
+	 */
+	static ThreadPool &shared();
+
+	/**
+	 * @brief Sets the maximal number of worker threads of all ThreadPool instances together.
+	 * @param thread_limit The new limit, 0 means no limit (default).
+	 *
+	 * The limit is applied when threads are created, already running threads are not stopped.
+	 *   A pool which cannot create any thread does not execute its tasks, so the limit should be
+	 *   set before pools are created.
+	 */
+	static void setGlobalThreadLimit(const unsigned thread_limit);
+
+	/**
+	 * @brief Gets the number of worker threads of all ThreadPool instances together.
+	 * @return The global thread count.
+	 */
+	NDMESSAGE static const unsigned globalThreadCount();
+
 	/**
 	 * @brief Gets the thread instance from the pool.
 	 * @param id The index of the thread.
@@ -127,6 +391,35 @@ public:
 	 */
 	NDMESSAGE const unsigned totalThreadCount() const;
 
+	/**
+	 * @brief Gets the index of the calling thread in this pool.
+	 * @return The index passed to tasks as `const int id`, -1 if the caller is not a worker of this pool.
+	 *
+	 * This lets code running in tasks without the id parameter (e.g. JobGraph jobs or systems)
+	 *   use per-worker storage, see EventChannel.
+	 */
+	NDMESSAGE const int currentWorkerIndex() const noexcept;
+
+	/**
+	 * @brief Gets the pool of the calling worker thread.
+	 * @return The pool, nullptr if the caller is not a worker thread of any pool.
+	 */
+	NDMESSAGE static ThreadPool *currentPool() noexcept;
+
+	/**
+	 * @brief Runs one queued task on the calling worker thread.
+	 * @return True if a task was executed, false if there is no task or the caller is not a worker
+	 *         of this pool.
+	 *
+	 * Workers waiting for nested work call it (see JobHandle::wait()), so the waited tasks are
+	 *   executed even if all workers of the pool are waiting, e.g. for systems of worlds which
+	 *   themselves run as tasks of the shared pool.
+	 *
+	 * Only tasks of the high and normal priority are taken. Background tasks and tasks of
+	 *   addInfiniteTask() are left to free workers, so they never delay or block the waiter.
+	 */
+	const bool runPendingTask();
+
 	/**
 	 * @brief Gets the number of idle threads in the pool.
 	 * @return The idle thread count.
@@ -139,16 +432,159 @@ public:
 	 */
 	NDMESSAGE const unsigned pendingTasksCount() const;
 
+	/**
+	 * @brief Gets the memory resource used for task storage.
+	 * @return The memory resource.
+	 */
+	NDMESSAGE std::pmr::memory_resource *getMemoryResource() const noexcept;
+
 	/**
 	 * @brief Resizes the thread pool (changes the number of working threads).
 	 * @param thread_count The new thread count.
 	 *
 	 * If the new thread count is lower than the previous one, all extra threads will finish their
 	 *   tasks and only then will be deleted.
-	 * If the new thread count is greater, the existing threads are left uninterrupted.
+	 * If the new thread count is greater, the existing threads are left uninterrupted. Only as many
+	 *   threads are added as the global thread limit allows.
 	 */
 	void resize(const unsigned thread_count);
 
+	/**
+	 * @brief Pins worker threads to CPUs.
+	 * @param policy The placement of workers, AffinityPolicy::None removes pinning.
+	 * @param topology The topology of the machine.
+	 *
+	 * The policy is also applied to threads created later by resize(). Pinned workers prefer tasks
+	 *   added with TaskOptions::node equal to their node, then tasks without a node and only then
+	 *   they help other nodes. Pinning is supported on Linux only, elsewhere workers stay unpinned.
+	 *
+	 * Example:
+	 * @code
+	 * ecs::ThreadPool TP(std::thread::hardware_concurrency());
+	 * TP.setAffinity(ecs::AffinityPolicy::Scatter);  // workers are spread across sockets
+	 * TP.addTask(ecs::TaskOptions{0u, 1u}, [](const int id) { touchMemoryOfNode1(); });
+	 * @endcode
+	 */
+	void setAffinity(const AffinityPolicy policy, const CpuTopology &topology = CpuTopology::system());
+
+	/**
+	 * @brief Limits the number of threads executing background tasks at the same time.
+	 * @param thread_limit The new limit, 0 means no limit (default).
+	 *
+	 * The remaining threads stay available for High and Normal tasks, so a long background task
+	 *   never delays ranges of frame-critical systems.
+	 *
+	 * Example:
+	 * @code
+	 * ecs::ThreadPool TP(8);
+	 * TP.setBackgroundThreadLimit(1);
+	 * TP.addTask(ecs::TaskOptions{0u, ecs::TaskOptions::anyNode, ecs::TaskPriority::Background},
+	 *     [](const int id) { writeSnapshot(); });
+	 * @endcode
+	 */
+	void setBackgroundThreadLimit(const unsigned thread_limit) noexcept;
+
+	/**
+	 * @brief Gets the limit of threads executing background tasks.
+	 * @return The limit, 0 means no limit.
+	 */
+	NDMESSAGE const unsigned backgroundThreadLimit() const noexcept;
+
+	/**
+	 * @brief Enables collection of per-thread metrics (disabled by default).
+	 * @param enabled True if metrics should be collected.
+	 *
+	 * Collection costs two clock reads per task and a few relaxed atomic increments on counters
+	 *   owned by the executing thread.
+	 */
+	void enableMetrics(const bool enabled) noexcept;
+
+	/**
+	 * @brief Takes the snapshot of metrics collected since the pool creation or resetMetrics().
+	 * @return Counters of every thread: executed tasks, busy and idle time, steals, queue latency
+	 *         and task duration histograms.
+	 *
+	 * The snapshot can be taken at any time, for example by a periodic task. It shows whether frame
+	 *   hitches come from queueing (high queue latency) or from execution (long task duration):
+	 * @code
+	 * TP.enableMetrics(true);
+	 * // ... frames ...
+	 * const ecs::WorkerMetrics total = TP.metrics().total();
+	 * std::cout << "p99 queue latency: " << total.queueLatency.percentile(0.99).count() << "ns, "
+	 *           << "utilization: " << total.utilization();
+	 * @endcode
+	 */
+	PoolMetrics metrics() const;
+
+	/**
+	 * @brief Sets all collected metrics to zero.
+	 */
+	void resetMetrics();
+
+	/**
+	 * @brief Sets the behaviour of idle worker threads.
+	 * @param policy The new policy, used by threads next time they find the queue empty.
+	 */
+	void setWaitPolicy(const WaitPolicy &policy) noexcept;
+
+	/**
+	 * @brief Gets the behaviour of idle worker threads.
+	 * @return The current policy.
+	 */
+	NDMESSAGE const WaitPolicy getWaitPolicy() const noexcept;
+
+	/**
+	 * @brief Starts the active frame, in which idle threads spin instead of parking.
+	 *
+	 * Parked threads are woken up, so the tasks of back-to-back calls (e.g. many applySystem()
+	 *   calls of one frame) start without the wake-up latency. Active frames may be nested or
+	 *   started by many Managers sharing the pool, threads park again when the last one ends.
+	 *
+	 * @code
+	 * TP.beginActiveFrame();
+	 * manager.applySystem<Position, Velocity>(move);
+	 * manager.applySystem<Position, Color>(paint);
+	 * TP.endActiveFrame();
+	 * @endcode
+	 *
+	 * @warning Idle threads keep all their CPUs busy until endActiveFrame() is called.
+	 */
+	void beginActiveFrame();
+
+	/**
+	 * @brief Ends the active frame started by beginActiveFrame().
+	 */
+	void endActiveFrame();
+
+	/**
+	 * @brief Gets the number of NUMA nodes which have their own task queue.
+	 * @return The node count.
+	 */
+	NDMESSAGE const unsigned nodeCount() const noexcept;
+
+	/**
+	 * @brief Gets the NUMA node of the worker thread.
+	 * @param index The index of the thread.
+	 * @return The node of the CPU the thread is pinned to, TaskOptions::anyNode if not pinned.
+	 */
+	NDMESSAGE const unsigned threadNode(const unsigned index) const;
+
+	/**
+	 * @brief Creates a new queue lane for a producer of tasks.
+	 * @return The index of the lane.
+	 *
+	 * Threads take tasks from non-empty lanes in round-robin order, so work of every producer (for
+	 *   example every Manager sharing this pool) progresses at a similar rate. Lane 0 is the default
+	 *   one used by addTask() overloads without TaskOptions.
+	 */
+	const unsigned createLane();
+
+	/**
+	 * @brief Returns the lane to the pool, so that it can be reused by createLane().
+	 * @param lane The index of the lane created by createLane().
+	 */
+	void releaseLane(const unsigned lane);
+
 	/**
 	 * @brief Stops all threads.
 	 * @param finish_tasks If true, all threads clear the queue before stopping, else they finish immediately.
@@ -276,6 +712,125 @@ public:
 	template <typename Functor, typename... Args>
 	auto addTask(Functor &&func, Args&& ...arguments) -> std::future<decltype(func(arguments...))>;
 
+	/**
+	 * @brief Adds a new task to the queue using additional options.
+	 * @param options The options of the task (e.g. its lane).
+	 * @param func The function which will be executed by one of the threads.
+	 * @tparam Functor Signature of the mentioned function. User doesn't need to explicitly specify it.
+	 * @return The std::future of the passed task, which after execution will hold the returned result (if any).
+	 *
+	 * Functions require the first argument to have a const int, because addTask() passes a thread
+	 *   id to it for the use by the function.
+	 *
+	 * Example:
+	 * @code
+	 * ecs::ThreadPool &TP = ecs::ThreadPool::shared();
+	 * const unsigned lane = TP.createLane();
+	 * TP.addTask(ecs::TaskOptions{lane}, [](const int id) { std::cout << "Hello from lane"; });
+	 * @endcode
+	 *
+	 * If the task is dropped because of its token or deadline, the returned future holds the
+	 *   std::future_error exception with the broken_promise code.
+	 */
+	template <typename Functor>
+	auto addTask(const TaskOptions &options, Functor &&func) -> std::future<decltype(func(0))>;
+
+	/**
+	 * @brief Adds many tasks to the queue at once.
+	 * @param functions The container of functions, every one is executed by one of the threads.
+	 * @param options The options of all tasks (e.g. their lane).
+	 * @tparam Container The type of the container. User doesn't need to explicitly specify it.
+	 * @return std::futures of passed tasks in the order of the container.
+	 *
+	 * Functions require the first argument to have a const int, because addTasks() passes a thread
+	 *   id to it for the use by the function.
+	 *
+	 * Unlike calling addTask() in a loop, the queue is locked once and parked threads are woken up
+	 *   once for the whole batch (as many of them as there are tasks).
+	 *
+	 * Example:
+	 * @code
+	 * std::vector<std::function<void(const int)>> ranges;
+	 * for(int i = 0; i < 8; i++) { ranges.push_back([i](const int id) { process(i); }); }
+	 * for(auto &result : TP.addTasks(ranges)) { result.get(); }
+	 * @endcode
+	 */
+	template <typename Container>
+	auto addTasks(Container &&functions, const TaskOptions &options = TaskOptions{})
+		-> std::vector<std::future<decltype((*std::begin(functions))(0))>>;
+
+	/**
+	 * @brief Adds a new task to the queue after the given delay.
+	 * @param delay The time after which the task is added to the queue.
+	 * @param func The function which will be executed by one of the threads.
+	 * @param options The options of the task (e.g. its priority).
+	 * @tparam Functor Signature of the mentioned function. User doesn't need to explicitly specify it.
+	 * @return The identifier of the task, which can be passed to cancelTimer().
+	 *
+	 * Functions require the first argument to have a const int, because the pool passes a thread
+	 *   id to it for the use by the function. Exceptions thrown by the function are discarded.
+	 *
+	 * Tasks are scheduled by a single timer thread, which sleeps until the nearest deadline, so
+	 *   waiting tasks don't occupy any worker. The timer thread is started by the first timer.
+	 *
+	 * Example:
+	 * @code
+	 * TP.addDelayedTask(std::chrono::seconds(5), [](const int id) { std::cout << "5 seconds later"; });
+	 * @endcode
+	 */
+	template <typename Functor>
+	TimerID addDelayedTask(
+		const std::chrono::steady_clock::duration delay,
+		Functor &&func,
+		const TaskOptions &options = TaskOptions{});
+
+	/**
+	 * @brief Adds a task to the queue every period.
+	 * @param period The time between consecutive runs.
+	 * @param func The function which will be executed by one of the threads.
+	 * @param mode The fixed-rate or the fixed-delay scheduling.
+	 * @param options The options of the task (e.g. its priority).
+	 * @tparam Functor Signature of the mentioned function. User doesn't need to explicitly specify it.
+	 * @return The identifier of the task, which can be passed to cancelTimer().
+	 *
+	 * Functions require the first argument to have a const int, because the pool passes a thread
+	 *   id to it for the use by the function. If the function throws, the task is cancelled.
+	 *   The task is cancelled as well once the token of the options is cancelled or the deadline
+	 *   of the options passes.
+	 *
+	 * The first run starts one period after this call. Runs of one task never overlap: in the
+	 *   fixed-rate mode ticks reached while the previous run is still in progress are skipped.
+	 *   Unlike addInfiniteTask(), the task occupies a worker only while it runs.
+	 *
+	 * Example:
+	 * @code
+	 * auto exporter = TP.addPeriodicTask(std::chrono::seconds(1), [](const int id) { exportStats(); });
+	 * // ...
+	 * TP.cancelTimer(exporter);
+	 * @endcode
+	 */
+	template <typename Functor>
+	TimerID addPeriodicTask(
+		const std::chrono::steady_clock::duration period,
+		Functor &&func,
+		const PeriodicMode mode = PeriodicMode::FixedRate,
+		const TaskOptions &options = TaskOptions{});
+
+	/**
+	 * @brief Cancels the delayed or periodic task.
+	 * @param id The identifier returned by addDelayedTask() or addPeriodicTask().
+	 * @return True if the task was cancelled, false if it doesn't exist (e.g. it has already run).
+	 *
+	 * A run which is already in progress is not interrupted.
+	 */
+	const bool cancelTimer(const TimerID id);
+
+	/**
+	 * @brief Gets the number of delayed and periodic tasks waiting for their time.
+	 * @return The timer count.
+	 */
+	NDMESSAGE const unsigned timerCount();
+
 	/**
 	 * @brief Adds a new infinite task to the queue.
 	 * @param func The function which will be executed by one of the threads.
@@ -289,6 +844,9 @@ public:
 	 *   body is nested inside a while(true) loop. This means that the function will be constantly
 	 *   executed until halt() or haltInfinite() is called.
 	 *
+	 * @note The task occupies its worker all the time. Work repeated in intervals should be added
+	 *       with addPeriodicTask() instead.
+	 *
 	 * Example:
 	 * @code
 	 * void task(const int thread_id) { std::cout << "Hello from thread " << thread_id << std::endl; }
@@ -423,6 +981,75 @@ private:
 	 */
 	void setupThread(const int index);
 
+	/**
+	 * @brief Pins the thread according to the current affinity policy.
+	 * @param index The index of the thread in the container.
+	 *
+	 * @warning For internal use only.
+	 */
+	void applyAffinity(const unsigned index);
+
+	/**
+	 * @brief Gets the identity of the calling worker thread.
+	 * @return The reference to the thread local identity, without a pool outside worker threads.
+	 *
+	 * @warning For internal use only.
+	 */
+	static impl::WorkerContext &currentWorker() noexcept;
+
+	/**
+	 * @brief Executes the popped task (or drops it if it has expired) and destroys it.
+	 * @param task The popped task.
+	 * @param index The index of the executing thread.
+	 * @param counters The metrics of the executing thread.
+	 * @param background True if the task holds a slot of the background thread limit.
+	 *
+	 * @warning For internal use only.
+	 */
+	void executeTask(impl::Task *task, const int index, impl::WorkerCounters &counters, const bool background);
+
+	/**
+	 * @brief Removes the task of the highest priority, preferring the queue of the given node.
+	 * @param task The removed task (it is an output result).
+	 * @param node The node of the calling thread.
+	 * @param background True if the removed task is a background one (it is an output result).
+	 * @return True if removed a task successfully, false otherwise.
+	 *
+	 * A background task is removed only if the background thread limit allows it. The caller
+	 *   releases the taken slot by decrementing m_backgroundThreadsCount after the execution.
+	 *
+	 * @warning For internal use only.
+	 */
+	const bool popTask(impl::Task *&task, const unsigned node, bool &background);
+
+	/**
+	 * @brief Removes the task of the given priority level, preferring the queue of the given node.
+	 * @param task The removed task (it is an output result).
+	 * @param node The node of the calling thread.
+	 * @param level The priority level.
+	 * @param finite_only True if tasks of addInfiniteTask() must not be removed.
+	 * @return True if removed a task successfully, false otherwise.
+	 *
+	 * @warning For internal use only.
+	 */
+	const bool popLevel(impl::Task *&task, const unsigned node, const unsigned level, const bool finite_only = false);
+
+	/**
+	 * @brief Spins and yields according to the wait policy until a task is available.
+	 * @param task The removed task (it is an output result).
+	 * @param node The node of the calling thread.
+	 * @param background True if the removed task is a background one (it is an output result).
+	 * @param abort_flag The abort flag of the calling thread.
+	 * @return True if removed a task, false if the thread should park.
+	 *
+	 * @warning For internal use only.
+	 */
+	const bool spinForTask(
+		impl::Task *&task,
+		const unsigned node,
+		bool &background,
+		const std::atomic<bool> &abort_flag);
+
 	/**
 	 * @brief Clears the queue of tasks.
 	 *
@@ -430,15 +1057,120 @@ private:
 	 */
 	void clearQueue();
 
+	/**
+	 * @brief Registers the timer and wakes up the timer thread (starting it if needed).
+	 * @param timer The new timer.
+	 * @param time The time of the first run.
+	 * @return The identifier of the timer.
+	 *
+	 * @warning For internal use only.
+	 */
+	TimerID scheduleTimer(std::shared_ptr<impl::Timer> &&timer, const std::chrono::steady_clock::time_point time);
+
+	/**
+	 * @brief Adds the run of the timer to the queue.
+	 * @param timer The timer whose time has come.
+	 *
+	 * @warning For internal use only.
+	 */
+	void runTimer(const std::shared_ptr<impl::Timer> &timer);
+
+	/**
+	 * @brief The loop of the timer thread, which waits for the nearest deadline.
+	 *
+	 * @warning For internal use only.
+	 */
+	void timerLoop();
+
+	/**
+	 * @brief Stops the timer thread and removes all timers.
+	 *
+	 * @warning For internal use only.
+	 */
+	void stopTimers();
+
+	/**
+	 * @brief Allocates a task from the memory resource of the pool.
+	 * @param callable The callable object wrapped by the task.
+	 * @return The pointer to the created task.
+	 *
+	 * @warning For internal use only.
+	 */
+	template <typename Callable>
+	impl::Task *createTask(Callable &&callable);
+
+	/**
+	 * @brief Destroys the task and returns its memory to the memory resource of the pool.
+	 * @param task The task created by createTask().
+	 *
+	 * @warning For internal use only.
+	 */
+	void destroyTask(impl::Task *task);
+
+	/**
+	 * @brief Pushes the task to the queue and notifies a waiting thread.
+	 * @param task The task created by createTask().
+	 * @param options The options of the task (its lane, node and priority).
+	 *
+	 * @warning For internal use only.
+	 */
+	void enqueueTask(impl::Task *task, const TaskOptions &options = TaskOptions{});
+
+	/**
+	 * @brief Pushes all tasks to the queue and notifies waiting threads once.
+	 * @param tasks Tasks created by createTask().
+	 * @param options The options of all tasks (their lane, node and priority).
+	 *
+	 * @warning For internal use only.
+	 */
+	void enqueueTasks(
+		const std::vector<impl::Task *> &tasks,
+		const TaskOptions &options = TaskOptions{});
+
+	/**
+	 * @brief Wakes up parked threads after tasks have been pushed.
+	 * @param task_count The number of pushed tasks.
+	 *
+	 * @warning For internal use only.
+	 */
+	void notifyParked(const unsigned task_count);
+
 private:
+	std::pmr::polymorphic_allocator<std::byte> m_allocator;  /**< The allocator used for task storage. */
 	std::vector<std::unique_ptr<std::thread>> m_threads;  /**< The container for threads. */
 	std::vector<std::shared_ptr<std::atomic<bool>>> m_abortFlags;  /**< Abort flags for threads. */
-	impl::SafeQueue<std::function<void(const int)> *> m_queue;  /**< The queue of tasks assigned by the user. */
+	std::vector<std::shared_ptr<std::atomic<unsigned>>> m_threadNodes;  /**< Nodes of pinned threads. */
+	std::vector<std::shared_ptr<impl::WorkerCounters>> m_workerCounters;  /**< Metrics of threads. */
+	std::atomic<bool> m_metricsEnabled;  /**< True if metrics are collected. */
+	impl::LaneQueue<impl::Task *> m_queue;  /**< The queue of tasks assigned by the user. */
+	std::vector<std::unique_ptr<impl::LaneQueue<impl::Task *>>> m_nodeQueues;  /**< Queues of tasks preferring a node. */
+	AffinityPolicy m_affinityPolicy;  /**< The placement of worker threads. */
+	CpuTopology m_topology;  /**< The topology used by the affinity policy. */
 	std::atomic<bool> m_finishedFlag;  /**< The flag describing if all tasks have benn completed. */
 	std::atomic<bool> m_haltFlag;  /**< The global flag used for hard halting computation of all threads. */
 	std::atomic<bool> m_infHaltFlag;  /**< The global flag used for breaking infinite tasks. */
-	std::atomic<unsigned> m_waitingThreadsCount;  /**< The number of idle threads. */
+	std::atomic<unsigned> m_waitingThreadsCount;  /**< The number of idle (parked) threads. */
+	std::atomic<unsigned> m_spinCount;  /**< WaitPolicy::spinCount of idle threads. */
+	std::atomic<unsigned> m_yieldCount;  /**< WaitPolicy::yieldCount of idle threads. */
+	std::atomic<unsigned> m_activeFrames;  /**< The number of active frames, see beginActiveFrame(). */
+	std::atomic<unsigned> m_backgroundThreadsCount;  /**< The number of threads executing background tasks. */
+	std::atomic<unsigned> m_backgroundThreadLimit;  /**< Limit of m_backgroundThreadsCount, 0 means no limit. */
 	std::atomic<unsigned> m_pendingTasksCount;  /**< The number of pending tasks in the queue. */
+	unsigned m_laneCount;  /**< The number of lanes created by createLane(), including the default one. */
+	std::vector<unsigned> m_freeLanes;  /**< Released lanes waiting for reuse. */
+	std::mutex m_laneMutex;  /**< The mutex guarding lane bookkeeping. */
+
+	inline static std::atomic<unsigned> m_globalThreadCount{0u};  /**< Threads of all pools together. */
+	inline static std::atomic<unsigned> m_globalThreadLimit{0u};  /**< Limit of m_globalThreadCount, 0 means no limit. */
+
+	using TimerEntry = std::pair<std::chrono::steady_clock::time_point, TimerID>;  /**< The deadline of a timer. */
+	std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> m_timerHeap;  /**< Deadlines, the nearest first. */
+	std::unordered_map<TimerID, std::shared_ptr<impl::Timer>> m_timers;  /**< Timers which have not been cancelled. */
+	TimerID m_nextTimerID;  /**< The identifier of the next timer. */
+	bool m_timerStop;  /**< True if the timer thread should finish. */
+	std::thread m_timerThread;  /**< The thread adding timers to the queue, started by the first timer. */
+	std::mutex m_timerMutex;  /**< The mutex guarding all timer members. */
+	std::condition_variable m_timerCond;  /**< Notified when the nearest deadline changes. */
 
 	std::mutex m_mutex;  /**< The global mutex of the ThreadPool class. */
 	std::condition_variable m_cond;  /**< The global condition variable used for notifying and syncing all threads. */
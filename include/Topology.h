@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Root.h"
+
+namespace ecs
+{
+
+/**
+ * @brief The description of logical CPUs and NUMA nodes of the machine.
+ *
+ * On Linux the topology is read from /sys/devices/system/cpu and /sys/devices/system/node. On
+ *   other systems (or if sysfs is not available) all std::thread::hardware_concurrency() CPUs
+ *   are placed on a single node.
+ */
+class CpuTopology
+{
+public:
+	/**
+	 * @brief The description of one logical CPU.
+	 */
+	struct Cpu
+	{
+		unsigned id = 0u;       /**< The index of the CPU used by the operating system. */
+		unsigned node = 0u;     /**< The NUMA node of the CPU. */
+		unsigned package = 0u;  /**< The physical package (socket) of the CPU. */
+		unsigned core = 0u;     /**< The physical core of the CPU within its package. */
+	};
+
+	/**
+	 * @brief Reads the topology of the machine.
+	 * @return The detected topology.
+	 */
+	static CpuTopology detect();
+
+	/**
+	 * @brief Gets the topology of the machine detected once per process.
+	 * @return The cached topology.
+	 */
+	static const CpuTopology &system();
+
+	/**
+	 * @brief Gets all online CPUs sorted by the node, package, core and id.
+	 * @return The CPUs.
+	 */
+	const std::vector<Cpu> &cpus() const noexcept;
+
+	/**
+	 * @brief Gets the number of NUMA nodes with at least one online CPU.
+	 * @return The node count (at least 1).
+	 */
+	const unsigned nodeCount() const noexcept;
+
+	/**
+	 * @brief Gets CPUs of the given node.
+	 * @param node The index of the node.
+	 * @return The online CPUs of the node.
+	 */
+	std::vector<Cpu> cpusOfNode(const unsigned node) const;
+
+	/**
+	 * @brief Parses the CPU list format used by sysfs (e.g. "0-3,8,10-11").
+	 * @param list The text of the list.
+	 * @return Indices of all listed CPUs.
+	 */
+	static std::vector<unsigned> parseCpuList(const std::string &list);
+
+private:
+	std::vector<Cpu> m_cpus;  /**< All online CPUs. */
+	unsigned m_nodeCount = 1u;  /**< The number of NUMA nodes with CPUs. */
+};
+
+/**
+ * @brief The placement of ThreadPool workers on CPUs.
+ */
+enum class AffinityPolicy
+{
+	None,     /**< Workers are not pinned, the operating system migrates them freely. */
+	Compact,  /**< Workers fill CPUs of the first node before the next one is used. */
+	Scatter   /**< Consecutive workers are placed on consecutive nodes. */
+};
+
+}  // namespace ecs
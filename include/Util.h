@@ -46,14 +46,125 @@
 		)
 #endif
 
+#if __cplusplus >= 202002L && __has_include(<span>)
+	#include <span>
+#endif
+
 namespace ecs
 {
+
+#if defined(__cpp_lib_span)
+	template <typename T>
+	using Span = std::span<T>;
+#else
+	/**
+	 * @brief The non-owning view of a contiguous sequence (std::span before C++20).
+	 * @tparam T The type of viewed elements.
+	 */
+	template <typename T>
+	class Span
+	{
+	public:
+		constexpr Span() noexcept = default;
+		constexpr Span(T *data, const std::size_t size) noexcept : m_data(data), m_size(size) { }
+
+		template <typename ContainerT>
+		constexpr Span(ContainerT &container) noexcept : m_data(container.data()), m_size(container.size()) { }
+
+		constexpr T *data() const noexcept { return m_data; }
+		constexpr std::size_t size() const noexcept { return m_size; }
+		constexpr bool empty() const noexcept { return m_size == 0u; }
+		constexpr T *begin() const noexcept { return m_data; }
+		constexpr T *end() const noexcept { return m_data + m_size; }
+		constexpr T &operator[](const std::size_t index) const noexcept { return m_data[index]; }
+
+	private:
+		T *m_data = nullptr;     /**< The first element. */
+		std::size_t m_size = 0u; /**< The number of elements. */
+	};
+#endif
+
+/**
+ * @brief The non-owning view of elements placed at a constant distance in memory.
+ * @tparam T The type of viewed elements.
+ *
+ * The view describes interleaved data (e.g. components inside ComponentWrapper) by the pointer
+ *   to the first element, the element count and the stride in bytes, which is the format
+ *   accepted by most vertex, physics and BLAS-like APIs.
+ */
+template <typename T>
+class StridedSpan
+{
+public:
+	using BytePointer = std::conditional_t<std::is_const<T>::value, const std::byte *, std::byte *>;
+
+	constexpr StridedSpan() noexcept = default;
+	constexpr StridedSpan(T *data, const std::size_t size, const std::size_t stride) noexcept
+	: m_data(data), m_size(size), m_stride(stride) { }
+
+	constexpr T *data() const noexcept { return m_data; }
+	constexpr std::size_t size() const noexcept { return m_size; }
+	constexpr std::size_t stride() const noexcept { return m_stride; }
+	constexpr bool empty() const noexcept { return m_size == 0u; }
+	constexpr bool contiguous() const noexcept { return m_stride == sizeof(T); }
+	T &operator[](const std::size_t index) const noexcept
+	{
+		return *reinterpret_cast<T *>(reinterpret_cast<BytePointer>(m_data) + index * m_stride);
+	}
+
+private:
+	T *m_data = nullptr;              /**< The first element. */
+	std::size_t m_size = 0u;          /**< The number of elements. */
+	std::size_t m_stride = sizeof(T); /**< The distance between consecutive elements in bytes. */
+};
+
+/**
+ * @brief The algorithm used to reorder components, see Manager::sort().
+ */
+enum class SortMode
+{
+	Full,        /**< Stable O(n log n) sort of arbitrary data. */
+	Incremental  /**< Insertion sort, close to O(n) for nearly sorted data (e.g. re-sorting every frame). */
+};
+
 namespace util
 {
 	std::size_t replace_all(std::string& inout, std::string_view what, std::string_view with);
 	std::size_t remove_all(std::string& inout, std::string_view what);
 	bool remove_string(std::string& inout, std::string_view what);
 
+	/**
+	 * @brief Gets the order of indices [0, count) sorted by the comparator.
+	 * @param count The number of sorted elements.
+	 * @param compare The comparator of two indices.
+	 * @param mode The sorting algorithm, both are stable.
+	 * @return The index of the element placed at every position.
+	 */
+	template <typename CompareT>
+	std::vector<std::size_t> sorted_order(const std::size_t count, CompareT compare, const SortMode mode)
+	{
+		std::vector<std::size_t> order(count);
+		std::iota(order.begin(), order.end(), std::size_t{0});
+		if(mode == SortMode::Full)
+		{
+			std::stable_sort(order.begin(), order.end(), compare);
+		}
+		else
+		{
+			for(std::size_t i = 1u; i < count; i++)
+			{
+				const std::size_t current = order[i];
+				std::size_t j = i;
+				for(; j > 0u && compare(current, order[j - 1u]); j--)
+				{
+					order[j] = order[j - 1u];
+				}
+				order[j] = current;
+			}
+		}
+		return order;
+	}
+
 	template <typename T>
 	constexpr auto type_name_to_string() noexcept
 	{
@@ -0,0 +1,41 @@
+#include "../include/Cancellation.h"
+
+namespace ecs
+{
+
+const bool CancellationToken::isCancelled() const noexcept
+{
+	return m_state && m_state->cancelled.load(std::memory_order_acquire);
+}
+
+const bool CancellationToken::canBeCancelled() const noexcept
+{
+	return static_cast<bool>(m_state);
+}
+
+CancellationToken::CancellationToken(std::shared_ptr<const impl::CancellationState> state)
+:
+m_state(std::move(state))
+{ }
+
+CancellationSource::CancellationSource()
+:
+m_state(std::make_shared<impl::CancellationState>())
+{ }
+
+CancellationToken CancellationSource::token() const
+{
+	return CancellationToken(m_state);
+}
+
+void CancellationSource::cancel() noexcept
+{
+	m_state->cancelled.store(true, std::memory_order_release);
+}
+
+const bool CancellationSource::isCancelled() const noexcept
+{
+	return m_state->cancelled.load(std::memory_order_acquire);
+}
+
+}  // namespace ecs
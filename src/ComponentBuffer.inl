@@ -5,9 +5,16 @@ namespace ecs
 // Constructor
 
 template <typename... Typepack>
-ComponentBuffer<meta::TypeList<Typepack...>>::ComponentBuffer(const uint64 max_entity_count)
+ComponentBuffer<meta::TypeList<Typepack...>>::ComponentBuffer(
+	const uint64 max_entity_count,
+	std::pmr::memory_resource *resource)
 :
-m_maxEntityCount(max_entity_count)
+m_cBuffer(ComponentBucket<Typepack>(resource)...),
+m_maxEntityCount(max_entity_count),
+m_resource(resource)
+#if ECS_RACE_DETECTOR
+, m_raceDetector({util::type_name_to_string<Typepack>()...})
+#endif
 {
 	auto help = [&](const uint64 &max, auto &vec)
 	{
@@ -16,7 +23,8 @@ m_maxEntityCount(max_entity_count)
 			vec.reserve(max);
 		}
 	};
-	((help(max_entity_count, this->getComponentBucket<Typepack>())), ...);
+	((help(max_entity_count, this->accessBucket<Typepack>())), ...);
+	m_groupOf.fill(noGroup);
 }
 
 
@@ -25,7 +33,37 @@ m_maxEntityCount(max_entity_count)
 
 template <typename... Typepack>
 template <typename ComponentT>
-std::vector<ComponentWrapper<ComponentT>> &ComponentBuffer<meta::TypeList<Typepack...>>::getComponentBucket()
+ComponentBucket<ComponentT> &ComponentBuffer<meta::TypeList<Typepack...>>::getComponentBucket()
+{
+	this->recordAccess<ComponentT>(debug::Access::Write);
+	return this->accessBucket<ComponentT>();
+}
+
+// ################################################################################################
+// getComponentBucket() const
+
+template <typename... Typepack>
+template <typename ComponentT>
+const ComponentBucket<ComponentT> &ComponentBuffer<meta::TypeList<Typepack...>>::getComponentBucket() const
+{
+	if constexpr(meta::DoesTypeExist<ComponentT, m_tPool>)
+	{
+		this->recordAccess<ComponentT>(debug::Access::Read);
+		return std::get<meta::IndexOf<ComponentWrapper<ComponentT>, m_cPool>>(m_cBuffer);
+	}
+	else
+	{
+		throw std::invalid_argument(
+			"template <typename ComponentT> const auto &getComponentBucket() const: There's no such component in ComponentPool.");
+	}
+}
+
+// ################################################################################################
+// accessBucket()
+
+template <typename... Typepack>
+template <typename ComponentT>
+ComponentBucket<ComponentT> &ComponentBuffer<meta::TypeList<Typepack...>>::accessBucket()
 {
 	if constexpr(meta::DoesTypeExist<ComponentT, m_tPool>)
 	{
@@ -38,6 +76,15 @@ std::vector<ComponentWrapper<ComponentT>> &ComponentBuffer<meta::TypeList<Typepa
 	}
 }
 
+// ################################################################################################
+// getMemoryResource()
+
+template <typename... Typepack>
+std::pmr::memory_resource *ComponentBuffer<meta::TypeList<Typepack...>>::getMemoryResource() const noexcept
+{
+	return m_resource;
+}
+
 // ################################################################################################
 // tryGetComponent()
 
@@ -75,9 +122,11 @@ template <typename... Typepack>
 template <typename ComponentT>
 ComponentT &ComponentBuffer<meta::TypeList<Typepack...>>::getComponent(const uint64 entity_id)
 {
-	if constexpr(meta::DoesTypeExist<ComponentT, m_tPool>)
+	using ValueT = std::remove_const_t<ComponentT>;
+	if constexpr(meta::DoesTypeExist<ValueT, m_tPool>)
 	{
-		for(auto &iter : this->getComponentBucket<ComponentT>())
+		this->recordAccess<ValueT>(std::is_const<ComponentT>::value ? debug::Access::Read : debug::Access::Write);
+		for(auto &iter : this->accessBucket<ValueT>())
 		{
 			if(iter.eID() == entity_id)
 			{
@@ -113,11 +162,118 @@ template <typename... Typepack>
 template <typename ComponentT>
 auto &ComponentBuffer<meta::TypeList<Typepack...>>::addComponent(const uint64 entity_id)
 {
-	return this->getComponentBucket<ComponentT>().emplace_back(
-		ComponentWrapper<ComponentT>(entity_id))();
+	this->recordAccess<ComponentT>(debug::Access::Write);
+	constexpr auto index = meta::IndexOf<ComponentT, m_tPool>;
+	auto &vec = this->accessBucket<ComponentT>();
+	vec.emplace_back(ComponentWrapper<ComponentT>(entity_id));
+	this->recordChange<index>(ComponentEvent::Added, entity_id);
+	return vec[this->joinGroup<index>(entity_id, vec.size() - 1u)]();
 	// there's additional parenthesis at the end to unwrap the component from ComponentWrapper
 }
 
+// ################################################################################################
+// addComponents()
+
+template <typename... Typepack>
+template <typename ComponentT>
+void ComponentBuffer<meta::TypeList<Typepack...>>::addComponents(
+	const uint64 first_entity_id,
+	const uint64 count,
+	const ComponentT &prototype,
+	const bool join_groups)
+{
+	this->recordAccess<ComponentT>(debug::Access::Write);
+	auto &vec = this->accessBucket<ComponentT>();
+	vec.reserve(vec.size() + count);  // single reallocation for the whole batch
+	for(uint64 id = first_entity_id, end = first_entity_id + count; id < end; id++)
+	{
+		vec.emplace_back(prototype, id);
+	}
+	constexpr auto index = meta::IndexOf<ComponentT, m_tPool>;
+	this->recordChange<index>(ComponentEvent::Added, first_entity_id, count);
+	if(join_groups)
+	{
+		this->joinGroups(uint64{1} << index, first_entity_id, count);
+	}
+}
+
+// ################################################################################################
+// joinGroups()
+
+template <typename... Typepack>
+void ComponentBuffer<meta::TypeList<Typepack...>>::joinGroups(
+	const uint64 components,
+	const uint64 first_entity_id,
+	const uint64 count,
+	const bool new_entities)
+{
+	for(std::size_t group = 0u; group < m_groups.size(); group++)
+	{
+		const uint64 owned = m_groups[group].owned;
+		if(!(owned & components) || (new_entities && (owned & ~components)))
+		{
+			continue;
+		}
+		if(count > joinBatchLimit)  // one pass for the whole batch instead of a lookup per entity
+		{
+			const auto leader = static_cast<std::size_t>(__builtin_ctzll(owned & components));
+			this->rebuildGroup(group, leader);
+			continue;
+		}
+		for(uint64 id = first_entity_id, end = first_entity_id + count; id < end; id++)
+		{
+			this->joinMember(group, id);
+		}
+	}
+}
+
+// ################################################################################################
+// insertComponents()
+
+template <typename... Typepack>
+template <typename ComponentT>
+void ComponentBuffer<meta::TypeList<Typepack...>>::insertComponents(
+	const uint64 first_entity_id,
+	Span<ComponentT> components)
+{
+	this->recordAccess<ComponentT>(debug::Access::Write);
+	auto &vec = this->accessBucket<ComponentT>();
+	const uint64 count = components.size();
+	vec.reserve(vec.size() + count);  // single reallocation for the whole batch
+	for(uint64 offset = 0u; offset < count; offset++)
+	{
+		vec.emplace_back(std::move(components[offset]), first_entity_id + offset);
+	}
+	constexpr auto index = meta::IndexOf<ComponentT, m_tPool>;
+	this->recordChange<index>(ComponentEvent::Added, first_entity_id, count);
+	this->joinGroups(uint64{1} << index, first_entity_id, count);
+}
+
+// ################################################################################################
+// viewComponents()
+
+template <typename... Typepack>
+template <typename ComponentT>
+StridedSpan<ComponentT> ComponentBuffer<meta::TypeList<Typepack...>>::viewComponents()
+{
+	auto &vec = this->getComponentBucket<ComponentT>();
+	return StridedSpan<ComponentT>(
+		vec.empty() ? nullptr : &vec.front()(),
+		vec.size(),
+		sizeof(ComponentWrapper<ComponentT>));
+}
+
+template <typename... Typepack>
+template <typename ComponentT>
+StridedSpan<const ComponentT> ComponentBuffer<meta::TypeList<Typepack...>>::viewComponents() const
+{
+	const auto &vec = this->getComponentBucket<ComponentT>();
+	return StridedSpan<const ComponentT>(
+		vec.empty() ? nullptr : &vec.front()(),
+		vec.size(),
+		sizeof(ComponentWrapper<ComponentT>));
+}
+
 // ################################################################################################
 // addComponentByIndex
 
@@ -125,8 +281,11 @@ template <typename... Typepack>
 template <uint16 decimalIndex>
 auto &ComponentBuffer<meta::TypeList<Typepack...>>::addComponentByIndex(const uint64 entity_id)
 {
-	return std::get<decimalIndex>(m_cBuffer).emplace_back(
-		ComponentWrapper<meta::TypeAt<decimalIndex, m_tPool>>(entity_id))();
+	RACE_DETECTOR_RECORD(m_raceDetector, decimalIndex, debug::Access::Write);
+	auto &vec = std::get<decimalIndex>(m_cBuffer);
+	vec.emplace_back(ComponentWrapper<meta::TypeAt<decimalIndex, m_tPool>>(entity_id));
+	this->recordChange<decimalIndex>(ComponentEvent::Added, entity_id);
+	return vec[this->joinGroup<decimalIndex>(entity_id, vec.size() - 1u)]();
 }
 
 // ################################################################################################
@@ -138,6 +297,7 @@ const std::optional<meta::TypeAt<decimalIndex, meta::TypeList<Typepack...>>> Com
 {
 	if constexpr(meta::DoesTypeExist<meta::TypeAt<decimalIndex, meta::TypeList<Typepack...>>, m_tPool>)  // type does not exist in component pool
 	{
+		RACE_DETECTOR_RECORD(m_raceDetector, decimalIndex, debug::Access::Read);
 		auto &vec = std::get<decimalIndex>(m_cBuffer);
 		for(auto &c : vec)
 		{
@@ -164,6 +324,7 @@ std::optional<meta::TypeAt<decimalIndex, meta::TypeList<Typepack...>>> Component
 {
 	if constexpr(meta::DoesTypeExist<meta::TypeAt<decimalIndex, meta::TypeList<Typepack...>>, m_tPool>)  // type does not exist in component pool
 	{
+		RACE_DETECTOR_RECORD(m_raceDetector, decimalIndex, debug::Access::Read);
 		auto &vec = std::get<decimalIndex>(m_cBuffer);
 		for(auto &c : vec)
 		{
@@ -188,7 +349,18 @@ template <typename... Typepack>
 template <uint16 Index>
 void ComponentBuffer<meta::TypeList<Typepack...>>::clear() noexcept
 {
+	if(m_observers[Index].active())
+	{
+		for(auto &cw : std::get<Index>(m_cBuffer))
+		{
+			m_observers[Index].removed.push_back(cw.eID());
+		}
+	}
 	std::get<Index>(m_cBuffer).clear();
+	if(m_groupOf[Index] != noGroup)
+	{
+		m_groups[m_groupOf[Index]].size = 0u;
+	}
 	if constexpr(Index > uint16{0})
 	{
 		this->clear<Index - uint16{1}>();
@@ -202,6 +374,7 @@ template <typename... Typepack>
 template <uint16 Index>
 const bool ComponentBuffer<meta::TypeList<Typepack...>>::checkComponent(const uint64 entity_id) const noexcept
 {
+	RACE_DETECTOR_RECORD(m_raceDetector, Index, debug::Access::Read);
 	auto &vec = std::get<Index>(m_cBuffer);
 	for(auto cw = vec.begin(); cw < vec.end(); cw++)
 	{
@@ -217,17 +390,21 @@ const bool ComponentBuffer<meta::TypeList<Typepack...>>::checkComponent(const ui
 // removeComponents()
 
 template <typename... Typepack>
-void ComponentBuffer<meta::TypeList<Typepack...>>::removeComponents(const uint64 entity_id) noexcept
+void ComponentBuffer<meta::TypeList<Typepack...>>::removeComponents(const uint64 entity_id)
 {
-	auto func = [&entity_id](auto& vec)
+	(this->recordAccess<Typepack>(debug::Access::Write), ...);
+	auto func = [&entity_id, this](auto& vec)
 	{
+		using WrapperT = typename std::decay_t<decltype(vec)>::value_type;
+		this->leaveGroup<meta::IndexOf<WrapperT, m_cPool>>(entity_id);  // members must not be swapped with the back
 		for(auto it = vec.begin(); it < vec.end(); it++)
 		{
 			if(it->eID() == entity_id)
 			{
 				// std::cout << "removing (" << (*it)() <<") of eID = " << it->eID() << std::endl;
-				std::swap(*it, vec.back());
-				vec.pop_back();
+				// recorded first, so the component stays in place if the observer list cannot grow
+				this->recordChange<meta::IndexOf<WrapperT, m_cPool>>(ComponentEvent::Removed, entity_id);
+				this->eraseFrom(vec, it);
 				break;
 			}
 		}
@@ -253,13 +430,15 @@ void ComponentBuffer<meta::TypeList<Typepack...>>::removeComponent(const uint64
 {
 	if constexpr(meta::DoesTypeExist<ComponentT, m_tPool>)
 	{
-		auto &vec = this->getComponentBucket<ComponentT>();
+		this->recordAccess<ComponentT>(debug::Access::Write);
+		this->leaveGroup<meta::IndexOf<ComponentT, m_tPool>>(entity_id);  // members must not be swapped with the back
+		auto &vec = this->accessBucket<ComponentT>();
 		for(auto it = vec.begin(); it < vec.end(); it++)
 		{
 			if(it->eID() == entity_id)
 			{
-				std::swap(*it, vec.back());
-				vec.pop_back();
+				this->eraseFrom(vec, it);
+				this->recordChange<meta::IndexOf<ComponentT, m_tPool>>(ComponentEvent::Removed, entity_id);
 				return;
 			}
 		}
@@ -273,6 +452,249 @@ void ComponentBuffer<meta::TypeList<Typepack...>>::removeComponent(const uint64
 	}
 }
 
+// ################################################################################################
+// setStableRemoval()
+
+template <typename... Typepack>
+void ComponentBuffer<meta::TypeList<Typepack...>>::setStableRemoval(const bool enabled) noexcept
+{
+	m_stableRemoval = enabled;
+}
+
+// ################################################################################################
+// observe()
+
+template <typename... Typepack>
+template <typename ComponentT>
+const uint64 ComponentBuffer<meta::TypeList<Typepack...>>::observe(
+	const ComponentEvent event,
+	ComponentObserver observer)
+{
+	if constexpr(meta::DoesTypeExist<ComponentT, m_tPool>)
+	{
+		auto &observers = m_observers[meta::IndexOf<ComponentT, m_tPool>];
+		auto &list = event == ComponentEvent::Added ? observers.onAdded : observers.onRemoved;
+		list.emplace_back(m_nextObserverID, std::move(observer));
+		return m_nextObserverID++;
+	}
+	else
+	{
+		throw std::invalid_argument(
+			"template <typename ComponentT> const uint64 observe(const ComponentEvent event, ComponentObserver observer): There's no such component in ComponentPool.");
+	}
+}
+
+// ################################################################################################
+// unobserve()
+
+template <typename... Typepack>
+void ComponentBuffer<meta::TypeList<Typepack...>>::unobserve(const uint64 observer_id)
+{
+	auto erase = [observer_id](auto &list)
+	{
+		list.erase(std::remove_if(list.begin(), list.end(), [observer_id](const auto &entry)
+		{
+			return entry.first == observer_id;
+		}), list.end());
+	};
+	for(auto &observers : m_observers)
+	{
+		erase(observers.onAdded);
+		erase(observers.onRemoved);
+		if(!observers.active())  // nobody is interested in pending changes anymore
+		{
+			observers.added.clear();
+			observers.removed.clear();
+		}
+	}
+}
+
+// ################################################################################################
+// flushObservers()
+
+template <typename... Typepack>
+void ComponentBuffer<meta::TypeList<Typepack...>>::flushObservers()
+{
+	for(auto &observers : m_observers)
+	{
+		// changes are moved out first, so observers modifying the buffer record them for the next flush
+		std::vector<uint64> added, removed;
+		std::swap(added, observers.added);
+		std::swap(removed, observers.removed);
+		if(!added.empty() && !removed.empty())
+		{
+			// additions and removals of one entity alternate, so multiset differences give net changes
+			std::sort(added.begin(), added.end());
+			std::sort(removed.begin(), removed.end());
+			std::vector<uint64> net_added, net_removed;
+			std::set_difference(added.begin(), added.end(), removed.begin(), removed.end(), std::back_inserter(net_added));
+			std::set_difference(removed.begin(), removed.end(), added.begin(), added.end(), std::back_inserter(net_removed));
+			added.swap(net_added);
+			removed.swap(net_removed);
+		}
+
+		auto deliver = [](const auto &list, const std::vector<uint64> &ids)
+		{
+			if(!ids.empty())
+			{
+				const auto callbacks = list;  // observers can be (un)registered by the callbacks
+				for(auto &entry : callbacks)
+				{
+					entry.second(Span<const uint64>(ids.data(), ids.size()));
+				}
+			}
+		};
+		deliver(observers.onRemoved, removed);
+		deliver(observers.onAdded, added);
+	}
+}
+
+// ################################################################################################
+// sort()
+
+template <typename... Typepack>
+template <typename ComponentT, typename CompareT>
+void ComponentBuffer<meta::TypeList<Typepack...>>::sort(CompareT compare, const SortMode mode)
+{
+	this->recordAccess<ComponentT>(debug::Access::Write);
+	constexpr auto index = meta::IndexOf<ComponentT, m_tPool>;
+	auto &vec = this->accessBucket<ComponentT>();
+	const std::size_t group = m_groupOf[index];
+	const std::size_t members = group != noGroup ? m_groups[group].size : 0u;
+	// members of the group and the rest are sorted separately, so members stay at the front
+	const auto order = util::sorted_order(vec.size(), [&vec, &compare, members](const std::size_t lhs, const std::size_t rhs)
+	{
+		if((lhs < members) != (rhs < members))
+		{
+			return lhs < members;
+		}
+		return compare(vec[lhs](), vec[rhs]());
+	}, mode);
+	ComponentBuffer::permute(vec, order);
+	if(group != noGroup)  // other owned buckets follow the new order of members
+	{
+		this->rebuildGroup(group, index);
+	}
+}
+
+// ################################################################################################
+// arrange()
+
+template <typename... Typepack>
+void ComponentBuffer<meta::TypeList<Typepack...>>::arrange(
+	const std::unordered_map<uint64, uint64> &ranks,
+	const SortMode mode)
+{
+	(this->recordAccess<Typepack>(debug::Access::Write), ...);
+	auto func = [&ranks, mode, this](auto &vec)
+	{
+		using WrapperT = typename std::decay_t<decltype(vec)>::value_type;
+		const std::size_t group = m_groupOf[meta::IndexOf<WrapperT, m_cPool>];
+		const std::size_t members = group != noGroup ? m_groups[group].size : 0u;
+
+		// ranks are looked up once, not by every comparison, members of the group stay at the front
+		std::vector<uint64> keys;
+		keys.reserve(vec.size());
+		for(std::size_t index = 0u; index < vec.size(); index++)
+		{
+			keys.push_back(ranks.at(vec[index].eID()) + (index < members ? uint64{0} : ranks.size()));
+		}
+		const auto order = util::sorted_order(vec.size(), [&keys](const std::size_t lhs, const std::size_t rhs)
+		{
+			return keys[lhs] < keys[rhs];
+		}, mode);
+		ComponentBuffer::permute(vec, order);
+	};
+	std::apply(
+		[&](auto& ...vec)
+		{
+			(func(vec), ...);
+		},
+		m_cBuffer
+	);
+}
+
+// ################################################################################################
+// group()
+
+template <typename... Typepack>
+template <typename... ComponentTs>
+void ComponentBuffer<meta::TypeList<Typepack...>>::group()
+{
+	static_assert(sizeof... (ComponentTs) > 0u, "The group has to own at least one component type.");
+	if constexpr((meta::DoesTypeExist<ComponentTs, m_tPool> && ...))
+	{
+		const uint64 owned = ((uint64{1} << meta::IndexOf<ComponentTs, m_tPool>) | ...);
+		for(auto &existing : m_groups)
+		{
+			if(existing.owned == owned)
+			{
+				return;
+			}
+		}
+		const std::size_t indices[] = {meta::IndexOf<ComponentTs, m_tPool>...};
+		for(auto index : indices)
+		{
+			if(m_groupOf[index] != noGroup)
+			{
+				throw std::logic_error(
+					"template <typename... ComponentTs> void group(): The component is already owned by another group.");
+			}
+		}
+		m_groups.push_back(impl::OwningGroup{owned, 0u});
+		for(auto index : indices)
+		{
+			m_groupOf[index] = m_groups.size() - 1u;
+		}
+		this->rebuildGroup(m_groups.size() - 1u, indices[0]);
+	}
+	else
+	{
+		throw std::invalid_argument(
+			"template <typename... ComponentTs> void group(): There's no such component in ComponentPool.");
+	}
+}
+
+// ################################################################################################
+// groupSize()
+
+template <typename... Typepack>
+template <typename... ComponentTs>
+const std::size_t ComponentBuffer<meta::TypeList<Typepack...>>::groupSize() const
+{
+	if constexpr((meta::DoesTypeExist<ComponentTs, m_tPool> && ...))
+	{
+		const uint64 owned = ((uint64{1} << meta::IndexOf<ComponentTs, m_tPool>) | ... | uint64{0});
+		for(auto &existing : m_groups)
+		{
+			if(existing.owned == owned)
+			{
+				return existing.size;
+			}
+		}
+	}
+	throw std::invalid_argument(
+		"template <typename... ComponentTs> const std::size_t groupSize() const: There's no such group.");
+}
+
+// ################################################################################################
+// hasGroup()
+
+template <typename... Typepack>
+template <typename... ComponentTs>
+const bool ComponentBuffer<meta::TypeList<Typepack...>>::hasGroup() const noexcept
+{
+	if constexpr((meta::DoesTypeExist<ComponentTs, m_tPool> && ...))
+	{
+		const uint64 owned = ((uint64{1} << meta::IndexOf<ComponentTs, m_tPool>) | ... | uint64{0});
+		return std::any_of(m_groups.begin(), m_groups.end(), [owned](const impl::OwningGroup &existing)
+		{
+			return existing.owned == owned;
+		});
+	}
+	return false;
+}
+
 // ################################################################################################
 // size()
 
@@ -302,7 +724,8 @@ template <typename... Typepack>
 template <typename ComponentT>
 const uint64 ComponentBuffer<meta::TypeList<Typepack...>>::bucketSize() const
 {
-	return this->getComponentBucket<ComponentT>().size();
+	this->recordAccess<ComponentT>(debug::Access::Read);
+	return std::get<meta::IndexOf<ComponentWrapper<ComponentT>, m_cPool>>(m_cBuffer).size();
 }
 
 // ################################################################################################
@@ -343,6 +766,252 @@ void ComponentBuffer<meta::TypeList<Typepack...>>::printAll() const
 	std::cout << std::endl;
 }
 
+// ################################################################################################
+// getRaceDetector()
+
+#if ECS_RACE_DETECTOR
+template <typename... Typepack>
+debug::RaceDetector &ComponentBuffer<meta::TypeList<Typepack...>>::getRaceDetector() noexcept
+{
+	return m_raceDetector;
+}
+#endif
+
+// ################################################################################################
+// recordAccess()
+
+template <typename... Typepack>
+template <typename ComponentT>
+void ComponentBuffer<meta::TypeList<Typepack...>>::recordAccess([[maybe_unused]] const debug::Access access) const
+{
+	RACE_DETECTOR_RECORD(m_raceDetector, (meta::IndexOf<ComponentT, m_tPool>), access);
+}
+
+// ################################################################################################
+// forEachBucket()
+
+template <typename... Typepack>
+template <typename FunctionT>
+void ComponentBuffer<meta::TypeList<Typepack...>>::forEachBucket(const uint64 owned, FunctionT function)
+{
+	auto func = [owned, &function](auto &vec)
+	{
+		using WrapperT = typename std::decay_t<decltype(vec)>::value_type;
+		if(owned & (uint64{1} << meta::IndexOf<WrapperT, m_cPool>))
+		{
+			function(vec);
+		}
+	};
+	std::apply(
+		[&](auto& ...vec)
+		{
+			(func(vec), ...);
+		},
+		m_cBuffer
+	);
+}
+
+// ################################################################################################
+// rebuildGroup()
+
+template <typename... Typepack>
+void ComponentBuffer<meta::TypeList<Typepack...>>::rebuildGroup(const std::size_t group, const std::size_t leader)
+{
+	auto &current = m_groups[group];
+	const std::size_t owned_count = std::bitset<64>(current.owned).count();
+	std::unordered_map<uint64, std::size_t> counts;
+	this->forEachBucket(current.owned, [&counts](auto &vec)
+	{
+		for(auto &cw : vec)
+		{
+			counts[cw.eID()]++;
+		}
+	});
+
+	// members keep their order from the leading bucket
+	std::unordered_map<uint64, std::size_t> ranks;
+	this->forEachBucket(uint64{1} << leader, [&counts, &ranks, owned_count](auto &vec)
+	{
+		for(auto &cw : vec)
+		{
+			if(counts[cw.eID()] == owned_count)
+			{
+				const std::size_t rank = ranks.size();
+				ranks.emplace(cw.eID(), rank);
+			}
+		}
+	});
+
+	// every owned bucket gets members in the rank order, the rest keeps its relative order
+	this->forEachBucket(current.owned, [&ranks](auto &vec)
+	{
+		std::vector<std::size_t> order(ranks.size());
+		std::vector<std::size_t> rest;
+		for(std::size_t index = 0u; index < vec.size(); index++)
+		{
+			const auto found = ranks.find(vec[index].eID());
+			if(found != ranks.end())
+			{
+				order[found->second] = index;
+			}
+			else
+			{
+				rest.push_back(index);
+			}
+		}
+		order.insert(order.end(), rest.begin(), rest.end());
+		ComponentBuffer::permute(vec, order);
+	});
+	current.size = ranks.size();
+}
+
+// ################################################################################################
+// joinGroup()
+
+template <typename... Typepack>
+template <std::size_t Index>
+const std::size_t ComponentBuffer<meta::TypeList<Typepack...>>::joinGroup(
+	const uint64 entity_id,
+	const std::size_t position)
+{
+	if(m_groupOf[Index] == noGroup)
+	{
+		return position;
+	}
+	return this->joinMember(m_groupOf[Index], entity_id).value_or(position);
+}
+
+// ################################################################################################
+// joinMember()
+
+template <typename... Typepack>
+std::optional<std::size_t> ComponentBuffer<meta::TypeList<Typepack...>>::joinMember(
+	const std::size_t group,
+	const uint64 entity_id)
+{
+	auto &current = m_groups[group];
+	auto matches = [entity_id](const auto &cw) { return cw.eID() == entity_id; };
+	auto find_received = [&current, &matches](auto &vec)
+	{
+		const auto found = std::find_if(vec.rbegin(), vec.rend() - current.size, matches);
+		return found == vec.rend() - current.size ? vec.end() : std::prev(found.base());
+	};
+	bool complete = true;
+	this->forEachBucket(current.owned, [&](auto &vec)
+	{
+		complete = complete && find_received(vec) != vec.end();
+	});
+	if(!complete)
+	{
+		return std::nullopt;
+	}
+
+	// the first non-member of every owned bucket is swapped with the new member
+	this->forEachBucket(current.owned, [&](auto &vec)
+	{
+		const auto found = find_received(vec);
+		if(m_stableRemoval)  // non-members are shifted instead, so they keep their order
+		{
+			std::rotate(vec.begin() + current.size, found, found + 1);
+		}
+		else
+		{
+			std::swap(*found, vec[current.size]);
+		}
+	});
+	return current.size++;
+}
+
+// ################################################################################################
+// leaveGroup()
+
+template <typename... Typepack>
+template <std::size_t Index>
+void ComponentBuffer<meta::TypeList<Typepack...>>::leaveGroup(const uint64 entity_id)
+{
+	if(m_groupOf[Index] == noGroup)
+	{
+		return;
+	}
+	auto &current = m_groups[m_groupOf[Index]];
+	auto matches = [entity_id](const auto &cw) { return cw.eID() == entity_id; };
+	auto &bucket = std::get<Index>(m_cBuffer);
+	if(!std::any_of(bucket.begin(), bucket.begin() + current.size, matches))
+	{
+		return;
+	}
+
+	// members have identical positions, so the last member of every owned bucket takes the place
+	this->forEachBucket(current.owned, [&](auto &vec)
+	{
+		const auto found = std::find_if(vec.begin(), vec.begin() + current.size, matches);
+		if(m_stableRemoval)  // members are shifted instead, so they keep their order
+		{
+			std::rotate(found, found + 1, vec.begin() + current.size);
+		}
+		else
+		{
+			std::swap(*found, vec[current.size - 1u]);
+		}
+	});
+	current.size--;
+}
+
+// ################################################################################################
+// permute()
+
+template <typename... Typepack>
+template <typename BucketT>
+void ComponentBuffer<meta::TypeList<Typepack...>>::permute(BucketT &bucket, const std::vector<std::size_t> &order)
+{
+	BucketT result(bucket.get_allocator());
+	result.reserve(bucket.capacity());  // keeps the memory reserved for the max entity count
+	for(auto index : order)
+	{
+		result.push_back(std::move(bucket[index]));
+	}
+	bucket.swap(result);
+}
+
+// ################################################################################################
+// eraseFrom()
+
+template <typename... Typepack>
+template <typename BucketT>
+void ComponentBuffer<meta::TypeList<Typepack...>>::eraseFrom(BucketT &bucket, const typename BucketT::iterator position)
+{
+	if(m_stableRemoval)
+	{
+		bucket.erase(position);
+	}
+	else
+	{
+		std::swap(*position, bucket.back());
+		bucket.pop_back();
+	}
+}
+
+// ################################################################################################
+// recordChange()
+
+template <typename... Typepack>
+template <std::size_t Index>
+void ComponentBuffer<meta::TypeList<Typepack...>>::recordChange(
+	const ComponentEvent event,
+	const uint64 first_entity_id,
+	const uint64 count)
+{
+	auto &observers = m_observers[Index];
+	if(observers.active())
+	{
+		auto &ids = event == ComponentEvent::Added ? observers.added : observers.removed;
+		for(uint64 id = first_entity_id, end = first_entity_id + count; id < end; id++)
+		{
+			ids.push_back(id);
+		}
+	}
+}
+
 // ComponentBuffer has to know somehow which components belong to which entities.
 // To achieve that, there are several ways:
 // 1) Create template struct wrapper containing component, id of entity and operator() overload;
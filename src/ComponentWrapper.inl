@@ -11,6 +11,16 @@ ComponentWrapper<ComponentT>::ComponentWrapper(const ComponentT &comp)
 : m_component(comp), m_entityID(0)
 { }
 
+template <typename ComponentT>
+ComponentWrapper<ComponentT>::ComponentWrapper(const ComponentT &comp, const uint64 &entity_id)
+: m_component(comp), m_entityID(entity_id)
+{ }
+
+template <typename ComponentT>
+ComponentWrapper<ComponentT>::ComponentWrapper(ComponentT &&comp, const uint64 &entity_id)
+: m_component(std::move(comp)), m_entityID(entity_id)
+{ }
+
 template <typename ComponentT>
 const ComponentT &ComponentWrapper<ComponentT>::operator()() const
 {
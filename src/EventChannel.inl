@@ -0,0 +1,117 @@
+namespace ecs
+{
+
+template <typename EventT>
+EventChannel<EventT>::EventChannel(ThreadPool &pool)
+:
+m_pool(pool),
+m_buffers(pool.totalThreadCount()),
+m_external(),
+m_externalMutex(),
+m_read(),
+m_ordered(false)
+{ }
+
+template <typename EventT>
+template <typename... Args>
+void EventChannel<EventT>::emit(Args &&...args)
+{
+	const int worker = m_pool.currentWorkerIndex();
+	auto append = [this, &args...](impl::EventBuffer<EventT> &buffer)
+	{
+		buffer.events.emplace_back(std::forward<Args>(args)...);
+		if(m_ordered)
+		{
+			buffer.keys.push_back(impl::currentEmitKey());
+		}
+	};
+	if(worker >= 0 && static_cast<std::size_t>(worker) < m_buffers.size())
+	{
+		append(m_buffers[worker]);
+	}
+	else  // not a worker of the pool, or a worker added by resize() since the last swap
+	{
+		std::lock_guard<std::mutex> lock(m_externalMutex);
+		append(m_external);
+	}
+}
+
+template <typename EventT>
+void EventChannel<EventT>::swap()
+{
+	std::size_t total = m_external.events.size();
+	for(const auto &buffer : m_buffers)
+	{
+		total += buffer.events.size();
+	}
+
+	m_read.clear();
+	m_read.reserve(total);
+	std::vector<impl::EmitKey> keys;
+	auto merge = [this, &keys](impl::EventBuffer<EventT> &buffer)
+	{
+		std::move(buffer.events.begin(), buffer.events.end(), std::back_inserter(m_read));
+		keys.insert(keys.end(), buffer.keys.begin(), buffer.keys.end());
+		buffer.events.clear();
+		buffer.keys.clear();
+	};
+	for(auto &buffer : m_buffers)
+	{
+		merge(buffer);
+	}
+	merge(m_external);
+
+	// a range runs on one thread, so the stable sort keeps events of every range in emission order
+	if(m_ordered && keys.size() == m_read.size())
+	{
+		const auto order = util::sorted_order(
+			keys.size(),
+			[&keys](const std::size_t lhs, const std::size_t rhs) { return keys[lhs] < keys[rhs]; },
+			SortMode::Full);
+		std::vector<EventT> sorted;
+		sorted.reserve(m_read.size());
+		for(auto index : order)
+		{
+			sorted.push_back(std::move(m_read[index]));
+		}
+		m_read.swap(sorted);
+	}
+
+	if(m_buffers.size() < m_pool.totalThreadCount())  // the pool has grown, the phase boundary is safe
+	{
+		m_buffers.resize(m_pool.totalThreadCount());
+	}
+}
+
+template <typename EventT>
+Span<const EventT> EventChannel<EventT>::read() const noexcept
+{
+	return Span<const EventT>(m_read.data(), m_read.size());
+}
+
+template <typename EventT>
+const std::size_t EventChannel<EventT>::size() const noexcept
+{
+	return m_read.size();
+}
+
+template <typename EventT>
+void EventChannel<EventT>::clear()
+{
+	for(auto &buffer : m_buffers)
+	{
+		buffer.events.clear();
+		buffer.keys.clear();
+	}
+	m_external.events.clear();
+	m_external.keys.clear();
+	m_read.clear();
+}
+
+template <typename EventT>
+void EventChannel<EventT>::setOrdered(const bool enabled) noexcept
+{
+	m_ordered = enabled;
+}
+
+}  // namespace ecs
@@ -0,0 +1,277 @@
+#include "../include/Hierarchy.h"
+
+namespace ecs
+{
+
+void Hierarchy::setParent(const uint64 child, const uint64 parent)
+{
+	if(child == parent)
+	{
+		throw std::invalid_argument(
+			"Hierarchy::setParent(): the entity " + std::to_string(child) + " cannot be its own parent");
+	}
+	const std::size_t child_slot = this->acquire(child);
+	const std::size_t parent_slot = this->acquire(parent);
+	for(std::size_t ancestor = parent_slot; ancestor != none; ancestor = m_nodes[ancestor].parent)
+	{
+		if(ancestor == child_slot)
+		{
+			throw std::logic_error(
+				"Hierarchy::setParent(): the entity " + std::to_string(parent) + " is a descendant of "
+				+ std::to_string(child));
+		}
+	}
+
+	this->unlink(child_slot);
+	Node &node = m_nodes[child_slot];
+	node.parent = parent_slot;
+	node.nextSibling = m_nodes[parent_slot].firstChild;
+	if(node.nextSibling != none)
+	{
+		m_nodes[node.nextSibling].prevSibling = child_slot;
+	}
+	m_nodes[parent_slot].firstChild = child_slot;
+	m_dirty = true;
+}
+
+void Hierarchy::detach(const uint64 entity)
+{
+	const std::size_t slot = this->find(entity);
+	if(slot != none)
+	{
+		this->unlink(slot);
+		m_dirty = true;
+	}
+}
+
+void Hierarchy::remove(const uint64 entity)
+{
+	const std::size_t slot = this->find(entity);
+	if(slot == none)
+	{
+		return;
+	}
+	this->unlink(slot);
+	for(std::size_t child = m_nodes[slot].firstChild; child != none; )
+	{
+		const std::size_t next = m_nodes[child].nextSibling;
+		m_nodes[child].parent = none;
+		m_nodes[child].nextSibling = none;
+		m_nodes[child].prevSibling = none;
+		child = next;
+	}
+	m_nodes[slot] = Node();
+	m_freeSlots.push_back(slot);
+	m_slots.erase(entity);
+	m_dirty = true;
+}
+
+void Hierarchy::clear()
+{
+	m_nodes.clear();
+	m_freeSlots.clear();
+	m_slots.clear();
+	m_order.clear();
+	m_dirty = false;
+}
+
+const bool Hierarchy::contains(const uint64 entity) const
+{
+	return this->find(entity) != none;
+}
+
+const uint64 Hierarchy::parentOf(const uint64 entity) const
+{
+	const std::size_t slot = this->find(entity);
+	return (slot != none && m_nodes[slot].parent != none) ? m_nodes[m_nodes[slot].parent].entity : none;
+}
+
+const uint64 Hierarchy::firstChildOf(const uint64 entity) const
+{
+	const std::size_t slot = this->find(entity);
+	return (slot != none && m_nodes[slot].firstChild != none) ? m_nodes[m_nodes[slot].firstChild].entity : none;
+}
+
+const uint64 Hierarchy::nextSiblingOf(const uint64 entity) const
+{
+	const std::size_t slot = this->find(entity);
+	return (slot != none && m_nodes[slot].nextSibling != none) ? m_nodes[m_nodes[slot].nextSibling].entity : none;
+}
+
+const std::size_t Hierarchy::size() const
+{
+	return m_slots.size();
+}
+
+const std::vector<Hierarchy::Entry> &Hierarchy::order()
+{
+	if(!m_dirty)
+	{
+		return m_order;
+	}
+
+	// preorder walk of every tree, the stack holds slots with positions of their parents
+	m_order.clear();
+	m_order.reserve(m_slots.size());
+	std::vector<std::pair<std::size_t, std::size_t>> stack;
+	std::vector<std::size_t> children;
+	for(std::size_t root = 0u; root < m_nodes.size(); root++)
+	{
+		if(m_nodes[root].entity == none || m_nodes[root].parent != none)
+		{
+			continue;
+		}
+		stack.emplace_back(root, none);
+		while(!stack.empty())
+		{
+			const auto [slot, parent_index] = stack.back();
+			stack.pop_back();
+			Node &node = m_nodes[slot];
+			const std::size_t index = m_order.size();
+			m_order.push_back(Entry{
+				node.entity,
+				parent_index != none ? m_order[parent_index].entity : none,
+				parent_index,
+				index + 1u});
+
+			// children are pushed in reverse, so the first child is visited first
+			children.clear();
+			for(std::size_t child = node.firstChild; child != none; child = m_nodes[child].nextSibling)
+			{
+				children.push_back(child);
+			}
+			for(auto child = children.rbegin(); child != children.rend(); child++)
+			{
+				stack.emplace_back(*child, index);
+			}
+		}
+	}
+
+	// descendants follow their ancestors, so a backward pass extends every subtree to its end
+	for(std::size_t index = m_order.size(); index-- > 0u; )
+	{
+		const std::size_t parent_index = m_order[index].parentIndex;
+		if(parent_index != none)
+		{
+			m_order[parent_index].subtreeEnd = std::max(m_order[parent_index].subtreeEnd, m_order[index].subtreeEnd);
+		}
+	}
+	m_dirty = false;
+	return m_order;
+}
+
+void Hierarchy::propagate(
+	ThreadPool &pool,
+	const std::function<void(const Entry &entry)> &function,
+	const TaskOptions &options)
+{
+	const auto &entries = this->order();
+	const std::size_t grain = entries.size() / (4u * std::max(1u, pool.totalThreadCount())) + 1u;
+	JobGraph graph;
+	auto add_range = [&graph, &entries, &function](const std::size_t first, const std::size_t last, const JobGraph::JobID parent_job)
+	{
+		return graph.addJob([&entries, &function, first, last]()
+		{
+			for(std::size_t current = first; current < last; current++)
+			{
+				function(entries[current]);
+			}
+		}, parent_job != none ? std::vector<JobGraph::JobID>{parent_job} : std::vector<JobGraph::JobID>{});
+	};
+
+	// every pending item is a run of sibling subtrees [first, last) and the job of their parent,
+	//   roots being the siblings without a parent; small subtrees are packed into one job, larger
+	//   ones get a job for their root and their children are split the same way
+	std::vector<std::tuple<std::size_t, std::size_t, JobGraph::JobID>> pending{{0u, entries.size(), none}};
+	while(!pending.empty())
+	{
+		const auto [first, last, parent_job] = pending.back();
+		pending.pop_back();
+		std::size_t packed = first;
+		for(std::size_t root = first; root < last; root = entries[root].subtreeEnd)
+		{
+			if(entries[root].subtreeEnd - root <= grain)
+			{
+				continue;
+			}
+			if(packed < root)
+			{
+				add_range(packed, root, parent_job);
+			}
+
+			// chains of single children cannot be split, they stay in the job of their top
+			std::size_t bottom = root;
+			while(bottom + 1u < entries[bottom].subtreeEnd
+				&& entries[bottom + 1u].subtreeEnd == entries[bottom].subtreeEnd
+				&& entries[bottom].subtreeEnd - bottom - 1u > grain)
+			{
+				bottom++;
+			}
+			const JobGraph::JobID job = add_range(root, bottom + 1u, parent_job);
+			pending.emplace_back(bottom + 1u, entries[bottom].subtreeEnd, job);
+			packed = entries[root].subtreeEnd;
+		}
+		if(packed < last)
+		{
+			add_range(packed, last, parent_job);
+		}
+	}
+	graph.submit(pool, options).wait();
+}
+
+// PRIVATE
+
+const std::size_t Hierarchy::acquire(const uint64 entity)
+{
+	const std::size_t found = this->find(entity);
+	if(found != none)
+	{
+		return found;
+	}
+	std::size_t slot = m_nodes.size();
+	if(!m_freeSlots.empty())
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		m_nodes.emplace_back();
+	}
+	m_nodes[slot].entity = entity;
+	m_slots.emplace(entity, slot);
+	m_dirty = true;
+	return slot;
+}
+
+const std::size_t Hierarchy::find(const uint64 entity) const
+{
+	const auto found = m_slots.find(entity);
+	return found != m_slots.end() ? found->second : none;
+}
+
+void Hierarchy::unlink(const std::size_t slot)
+{
+	Node &node = m_nodes[slot];
+	if(node.parent == none)
+	{
+		return;
+	}
+	if(node.prevSibling != none)
+	{
+		m_nodes[node.prevSibling].nextSibling = node.nextSibling;
+	}
+	else
+	{
+		m_nodes[node.parent].firstChild = node.nextSibling;
+	}
+	if(node.nextSibling != none)
+	{
+		m_nodes[node.nextSibling].prevSibling = node.prevSibling;
+	}
+	node.parent = none;
+	node.nextSibling = none;
+	node.prevSibling = none;
+}
+
+}  // namespace ecs
@@ -3,12 +3,18 @@
 namespace ecs
 {
 
-Interface::Interface(const uint64 &id, const uint64 &index, uint64 &flag_bitset, const uint64 &component_bitset)
+Interface::Interface(
+	const uint64 &id,
+	const uint64 &index,
+	uint64 &flag_bitset,
+	const uint64 &component_bitset,
+	Resources *resources)
 :
 m_id(id),
 m_index(index),
 m_flagBitset(flag_bitset),
-m_compBitset(component_bitset)
+m_compBitset(component_bitset),
+m_resources(resources)
 { }
 
 const uint64 &Interface::id() const
@@ -0,0 +1,213 @@
+#include "../include/JobGraph.h"
+
+namespace ecs
+{
+
+JobGraph::JobID JobGraph::addJob(
+	std::function<void()> job,
+	const std::vector<JobID> &dependencies,
+	const unsigned node)
+{
+	const JobID id = m_nodes.size();
+	m_nodes.push_back(Node{std::move(job), {}, 0u, node});
+	for(auto dependency : dependencies)
+	{
+		this->addDependency(id, dependency);
+	}
+	return id;
+}
+
+void JobGraph::addDependency(const JobID job, const JobID dependency)
+{
+	if(job >= m_nodes.size() || dependency >= m_nodes.size() || job == dependency)
+	{
+		throw std::invalid_argument(
+			"JobGraph::addDependency(): wrong job indices " + std::to_string(job) + " and "
+			+ std::to_string(dependency));
+	}
+	m_nodes[dependency].successors.push_back(job);
+	m_nodes[job].dependencyCount++;
+	m_ordered = m_ordered && (dependency < job);
+}
+
+const std::size_t JobGraph::jobCount() const
+{
+	return m_nodes.size();
+}
+
+void JobGraph::clear()
+{
+	m_nodes.clear();
+	m_ordered = true;
+}
+
+JobHandle JobGraph::submit(ThreadPool &pool, const TaskOptions &options) const
+{
+	if(!m_ordered && this->hasCycle())
+	{
+		throw std::logic_error("JobGraph::submit(): dependencies of jobs form a cycle");
+	}
+
+	auto run = std::make_shared<impl::GraphRun>();
+	run->graph = this;
+	run->pool = (pool.totalThreadCount() > 0u) ? &pool : nullptr;
+	run->options = options;
+	run->pending.reset(new std::atomic<unsigned>[m_nodes.size()]);
+	run->handle = JobHandle(static_cast<unsigned>(m_nodes.size()));
+	for(JobID id = 0u; id < m_nodes.size(); id++)
+	{
+		run->pending[id] = m_nodes[id].dependencyCount;
+	}
+
+	// counters are set, so jobs can be started
+	const JobHandle handle = run->handle;
+	std::vector<JobID> roots;
+	for(JobID id = 0u; id < m_nodes.size(); id++)
+	{
+		if(m_nodes[id].dependencyCount == 0u)
+		{
+			roots.push_back(id);
+		}
+	}
+	JobGraph::dispatch(run, roots);
+	return handle;
+}
+
+// PRIVATE
+
+void JobGraph::process(const std::shared_ptr<impl::GraphRun> &run, const JobID job)
+{
+	const auto &nodes = run->graph->m_nodes;
+	std::vector<JobID> ready{job};  // jobs completed by this thread
+	while(!ready.empty())
+	{
+		const JobID current = ready.back();
+		ready.pop_back();
+
+		const Node &node = nodes[current];
+		if(node.job && !run->failed && !JobGraph::expired(*run))
+		{
+			try
+			{
+				node.job();
+			}
+			catch(...)
+			{
+				run->failed = true;
+				run->handle.setException(std::current_exception());
+			}
+		}
+
+		// successors are started before this job completes, so the handle cannot be done earlier
+		std::vector<JobID> queued;
+		for(auto successor : node.successors)
+		{
+			if(run->pending[successor].fetch_sub(1u) == 1u)  // this was the last dependency
+			{
+				if(!nodes[successor].job || run->pool == nullptr)
+				{
+					ready.push_back(successor);
+				}
+				else
+				{
+					queued.push_back(successor);
+				}
+			}
+		}
+		JobGraph::dispatch(run, queued);
+		run->handle.completeTask();
+	}
+}
+
+void JobGraph::dispatch(const std::shared_ptr<impl::GraphRun> &run, const std::vector<JobID> &jobs)
+{
+	const auto &nodes = run->graph->m_nodes;
+	std::vector<JobID> pooled;
+	for(auto job : jobs)
+	{
+		if(run->pool == nullptr || !nodes[job].job)
+		{
+			JobGraph::process(run, job);
+		}
+		else
+		{
+			pooled.push_back(job);
+		}
+	}
+
+	// jobs preferring the same node are added at once, so threads are woken up once per batch
+	std::sort(pooled.begin(), pooled.end(), [&nodes](const JobID lhs, const JobID rhs)
+	{
+		return nodes[lhs].node < nodes[rhs].node;
+	});
+	for(std::size_t first = 0u; first < pooled.size(); )
+	{
+		TaskOptions options = run->options;
+		options.token = CancellationToken();  // dropped tasks would never complete the handle
+		options.deadline = std::chrono::steady_clock::time_point();
+		const unsigned node = nodes[pooled[first]].node;
+		if(node != TaskOptions::anyNode)
+		{
+			options.node = node;
+		}
+
+		auto make_task = [&run](const JobID job)
+		{
+			return [run, job](const int) { JobGraph::process(run, job); };
+		};
+		std::vector<decltype(make_task(0u))> tasks;
+		std::size_t last = first;
+		for(; last < pooled.size() && nodes[pooled[last]].node == node; last++)
+		{
+			tasks.push_back(make_task(pooled[last]));
+		}
+		if(run->pool->addTasks(std::move(tasks), options).empty())  // the pool is halted
+		{
+			for(; first < last; first++)
+			{
+				JobGraph::process(run, pooled[first]);
+			}
+		}
+		first = last;
+	}
+}
+
+const bool JobGraph::expired(const impl::GraphRun &run)
+{
+	const auto deadline = run.options.deadline;
+	return run.options.token.isCancelled()
+		|| (deadline != std::chrono::steady_clock::time_point() && std::chrono::steady_clock::now() > deadline);
+}
+
+const bool JobGraph::hasCycle() const
+{
+	// Kahn's algorithm, jobs left with dependencies are on a cycle
+	std::vector<unsigned> pending(m_nodes.size());
+	std::vector<JobID> ready;
+	for(JobID id = 0u; id < m_nodes.size(); id++)
+	{
+		pending[id] = m_nodes[id].dependencyCount;
+		if(pending[id] == 0u)
+		{
+			ready.push_back(id);
+		}
+	}
+
+	std::size_t visited = 0u;
+	while(!ready.empty())
+	{
+		const JobID current = ready.back();
+		ready.pop_back();
+		visited++;
+		for(auto successor : m_nodes[current].successors)
+		{
+			if(--pending[successor] == 0u)
+			{
+				ready.push_back(successor);
+			}
+		}
+	}
+	return visited != m_nodes.size();
+}
+
+}  // namespace ecs
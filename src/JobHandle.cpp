@@ -0,0 +1,152 @@
+#include "../include/JobHandle.h"
+#include "../include/ThreadPool.h"
+
+namespace ecs
+{
+
+JobHandle::JobHandle()
+:
+m_state(std::make_shared<impl::JobState>())
+{
+	m_state->done = true;
+}
+
+JobHandle::JobHandle(const unsigned task_count)
+:
+m_state(std::make_shared<impl::JobState>())
+{
+	m_state->remaining = task_count;
+	m_state->done = (task_count == 0u);
+}
+
+const bool JobHandle::isDone() const
+{
+	std::unique_lock<std::mutex> lock(m_state->mutex);
+	return m_state->done;
+}
+
+void JobHandle::wait()
+{
+	// a worker waiting for nested work runs queued tasks meanwhile, otherwise workers of a shared
+	//   pool could all wait for tasks which nobody executes
+	ThreadPool *pool = ThreadPool::currentPool();
+	std::vector<std::future<void>> futures;
+	std::exception_ptr exception;
+	{  // safety scope for std::unique_lock
+		std::unique_lock<std::mutex> lock(m_state->mutex);
+		while(pool != nullptr && !m_state->done)
+		{
+			lock.unlock();
+			const bool executed = pool->runPendingTask();
+			lock.lock();
+			if(!executed)  // the remaining tasks run elsewhere, completion notifies the condition
+			{
+				m_state->cond.wait_for(lock, std::chrono::microseconds(100), [this]() { return m_state->done; });
+			}
+		}
+		m_state->cond.wait(lock, [this]() { return m_state->done; });
+		futures.swap(m_state->futures);  // exceptions of tasks are rethrown only once
+		std::swap(exception, m_state->exception);
+	}
+	for(auto &future : futures)
+	{
+		future.get();  // rethrows the exception thrown by the task
+	}
+	if(exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+JobHandle JobHandle::then(std::function<void()> continuation)
+{
+	JobHandle next(1u);
+	auto run = [continuation = std::move(continuation), next]()
+	{
+		try
+		{
+			continuation();
+		}
+		catch(...)
+		{
+			next.setException(std::current_exception());
+		}
+		next.completeTask();
+	};
+
+	{  // safety scope for std::unique_lock
+		std::unique_lock<std::mutex> lock(m_state->mutex);
+		if(!m_state->done)
+		{
+			m_state->continuations.push_back(std::move(run));
+			return next;
+		}
+	}
+	run();  // the job is already done
+	return next;
+}
+
+void JobHandle::waitAll(std::vector<JobHandle> &handles)
+{
+	std::exception_ptr exception;
+	for(auto &handle : handles)
+	{
+		try
+		{
+			handle.wait();
+		}
+		catch(...)  // the remaining jobs still have to finish
+		{
+			if(!exception)
+			{
+				exception = std::current_exception();
+			}
+		}
+	}
+	if(exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+void JobHandle::attach(std::future<void> &&future)
+{
+	if(!future.valid())  // the task will never run
+	{
+		this->completeTask();
+		return;
+	}
+	std::unique_lock<std::mutex> lock(m_state->mutex);
+	m_state->futures.push_back(std::move(future));
+}
+
+void JobHandle::completeTask() const
+{
+	if(m_state->remaining.fetch_sub(1u) != 1u)  // not the last task
+	{
+		return;
+	}
+
+	std::vector<std::function<void()>> continuations;
+	{  // safety scope for std::unique_lock
+		std::unique_lock<std::mutex> lock(m_state->mutex);
+		m_state->done = true;
+		continuations.swap(m_state->continuations);
+	}
+	m_state->cond.notify_all();
+	for(auto &continuation : continuations)
+	{
+		continuation();
+	}
+}
+
+void JobHandle::setException(std::exception_ptr exception) const
+{
+	std::unique_lock<std::mutex> lock(m_state->mutex);
+	if(!m_state->exception)
+	{
+		m_state->exception = exception;
+	}
+}
+
+}  // namespace ecs
@@ -3,20 +3,40 @@ namespace ecs
 {
 
 template <typename TypeListT>
-uint64 Manager<TypeListT>::m_nextEntityID = uint64{0};
-
-template <typename TypeListT>
-Manager<TypeListT> &Manager<TypeListT>::getInstance(const uint64 max_entity_count)
+Manager<TypeListT> &Manager<TypeListT>::getInstance(
+	const uint64 max_entity_count,
+	std::pmr::memory_resource *resource)
 {
-	static Manager<TypeListT> instance(max_entity_count);
+	static Manager<TypeListT> instance(max_entity_count, resource);
 	return instance;
 }
 
-// private constructor
 template <typename TypeListT>
-Manager<TypeListT>::Manager(const uint64 max_entity_count)
+Manager<TypeListT>::Manager(
+	const uint64 max_entity_count,
+	std::pmr::memory_resource *resource)
+:
+Manager(max_entity_count, std::make_unique<ThreadPool>(std::thread::hardware_concurrency()), resource)
+{ }
+
+template <typename TypeListT>
+Manager<TypeListT>::Manager(
+	const uint64 max_entity_count,
+	ThreadPool &thread_pool,
+	std::pmr::memory_resource *resource)
 :
-m_threadPool(std::thread::hardware_concurrency()),
+m_entityBuffer(resource),
+m_entityFlags(resource),
+m_entityComponents(resource),
+m_componentBuffer(max_entity_count, resource),
+m_ownedThreadPool(),
+m_threadPool(&thread_pool),
+m_lane(thread_pool.createLane()),
+m_numaPartitioning(false),
+m_deterministic(false),
+m_chunkSize(defaultChunkSize),
+m_dispatchCount(uint64{0}),
+m_nextEntityID(uint64{0}),
 m_flagCount(uint16{0}),
 m_maxEntityCount(max_entity_count),
 m_entityCount(uint64{0})
@@ -36,6 +56,24 @@ m_entityCount(uint64{0})
 	}
 }
 
+template <typename TypeListT>
+Manager<TypeListT>::~Manager()
+{
+	m_threadPool->releaseLane(m_lane);
+}
+
+// private constructor taking ownership of the pool
+template <typename TypeListT>
+Manager<TypeListT>::Manager(
+	const uint64 max_entity_count,
+	std::unique_ptr<ThreadPool> &&owned_thread_pool,
+	std::pmr::memory_resource *resource)
+:
+Manager(max_entity_count, *owned_thread_pool, resource)
+{
+	m_ownedThreadPool = std::move(owned_thread_pool);
+}
+
 template <typename TypeListT>
 template <uint16 TypeIndex>
 void Manager<TypeListT>::addComponent(const uint64 entity_id)
@@ -81,14 +119,14 @@ ComponentT &Manager<TypeListT>::getComponent(const uint64 entity_id)
 
 template <typename TypeListT>
 template <uint16 TypeIndex>
-std::vector<ComponentWrapper<meta::TypeAt<TypeIndex, TypeListT>>> &Manager<TypeListT>::getComponentBucket()
+ComponentBucket<meta::TypeAt<TypeIndex, TypeListT>> &Manager<TypeListT>::getComponentBucket()
 {
 	return m_componentBuffer.template getComponentBucket<meta::TypeAt<TypeIndex, TypeListT>>();
 }
 
 template <typename TypeListT>
 template <typename ComponentT>
-std::vector<ComponentWrapper<ComponentT>> &Manager<TypeListT>::getComponentBucket()
+ComponentBucket<ComponentT> &Manager<TypeListT>::getComponentBucket()
 {
 	return m_componentBuffer.template getComponentBucket<ComponentT>();
 }
@@ -111,15 +149,21 @@ const bool Manager<TypeListT>::checkComponent(const uint64 entity_id) const noex
 template <typename TypeListT>
 ThreadPool &Manager<TypeListT>::getThreadPool()
 {
-	return m_threadPool;
+	return *m_threadPool;
 }
 
 template <typename TypeListT>
-const std::vector<uint64> &Manager<TypeListT>::getEntityBuffer() const
+const std::pmr::vector<uint64> &Manager<TypeListT>::getEntityBuffer() const
 {
 	return m_entityBuffer;
 }
 
+template <typename TypeListT>
+std::pmr::memory_resource *Manager<TypeListT>::getMemoryResource() const noexcept
+{
+	return m_componentBuffer.getMemoryResource();
+}
+
 template <typename TypeListT>
 template <uint16 ComponentCount>
 const uint64 &Manager<TypeListT>::addEntity(const uint64 components, const uint64 flags)
@@ -148,6 +192,52 @@ const uint64 &Manager<TypeListT>::addEntity(const uint64 components, const uint6
 	return m_entityBuffer.back();
 }
 
+template <typename TypeListT>
+const uint64 Manager<TypeListT>::addEntities(const uint64 count, const uint64 components, const uint64 flags)
+{
+	return this->addEntitiesFrom(components, flags, meta::metautil::TupleOfTypes<TypeListT>{}, count);
+}
+
+template <typename TypeListT>
+const uint64 Manager<TypeListT>::spawn(const Prefab<TypeListT> &prefab, const uint64 count)
+{
+	return this->addEntitiesFrom(prefab.components(), prefab.flags(), prefab.prototypes(), count);
+}
+
+template <typename TypeListT>
+template <typename ComponentT>
+void Manager<TypeListT>::insertComponents(const uint64 first_entity_id, Span<ComponentT> components)
+{
+	const uint64 count = components.size();
+	const uint64 bit = meta::ComponentBit<ComponentT, TypeListT>;
+	const auto first = std::find(m_entityBuffer.begin(), m_entityBuffer.end(), first_entity_id);
+	const uint64 position = first - m_entityBuffer.begin();
+	bool valid = count <= m_entityCount - std::min(position, m_entityCount);
+	for(uint64 offset = 0u; valid && offset < count; offset++)
+	{
+		valid = m_entityBuffer[position + offset] == first_entity_id + offset
+			&& (m_entityComponents[position + offset] & bit) == uint64{0};
+	}
+	if(!valid)
+	{
+		throw std::invalid_argument(
+			"Manager::insertComponents(): entities have to be stored one after another and have no such component");
+	}
+
+	m_componentBuffer.template insertComponents<ComponentT>(first_entity_id, components);
+	for(uint64 offset = 0u; offset < count; offset++)  // only once the components are stored
+	{
+		m_entityComponents[position + offset] |= bit;
+	}
+}
+
+template <typename TypeListT>
+template <typename ComponentT>
+StridedSpan<ComponentT> Manager<TypeListT>::viewComponents()
+{
+	return m_componentBuffer.template viewComponents<ComponentT>();
+}
+
 template <typename TypeListT>
 void Manager<TypeListT>::deleteEntity(const uint64 entity_id)
 {
@@ -165,7 +255,16 @@ void Manager<TypeListT>::deleteEntity(const uint64 entity_id)
 	if(exists)
 	{
 		m_componentBuffer.removeComponents(*e);
+		m_hierarchy.remove(*e);
 		auto pos = e - m_entityBuffer.begin();
+		if(m_deterministic)  // the order of remaining entities does not depend on the order of deletions
+		{
+			m_entityBuffer.erase(e);
+			m_entityFlags.erase(m_entityFlags.begin() + pos);
+			m_entityComponents.erase(m_entityComponents.begin() + pos);
+			m_entityCount--;
+			return;
+		}
 		std::swap(*e, m_entityBuffer.back());
 		m_entityBuffer.pop_back();
 		std::swap(m_entityFlags.at(pos), m_entityFlags.back());
@@ -200,7 +299,8 @@ void Manager<TypeListT>::deleteAllEntities()
 	m_entityFlags.clear();
 	m_flagCount = uint16{0};
 
-	// clear entity buffer
+	// clear entity buffer and relationships
+	m_hierarchy.clear();
 	m_entityBuffer.clear();
 	m_entityCount = uint64{0};
 }
@@ -320,7 +420,7 @@ void Manager<TypeListT>::setFlagsForAll(const uint64 flagBit, const bool value)
 }
 
 template <typename TypeListT>
-std::vector<uint64> &Manager<TypeListT>::getFlagBuffer()
+std::pmr::vector<uint64> &Manager<TypeListT>::getFlagBuffer()
 {
 	return m_entityFlags;
 }
@@ -373,7 +473,7 @@ void Manager<TypeListT>::applySystem(std::function<void(ComponentListT& ...)> &s
 			}
 		}
 	};
-	this->applySystemHelper(execute);
+	this->applySystemHelper(SystemRecord{uint64{0}, bitset, execute, "applySystem"});
 }
 
 template <typename TypeListT>
@@ -402,7 +502,7 @@ void Manager<TypeListT>::applySystem(void (*system)(Interface &interface, Compon
 	{
 		for(uint64 i = start; i < stop; i++)
 		{
-			Interface interface(m_entityBuffer[i], i, m_entityFlags[i], m_entityComponents[i]);
+			Interface interface(m_entityBuffer[i], i, m_entityFlags[i], m_entityComponents[i], &m_resources);
 			if((bitset & m_entityComponents[i]) == bitset)  // if tested entity has requested components
 			{
 				// for every matching entity, pass to system (which in fact is an ECS System) tuple of arguments
@@ -410,7 +510,7 @@ void Manager<TypeListT>::applySystem(void (*system)(Interface &interface, Compon
 			}
 		}
 	};
-	this->applySystemHelper(execute);
+	this->applySystemHelper(SystemRecord{uint64{0}, bitset, execute, "applySystem"});
 }
 
 template <typename TypeListT>
@@ -433,7 +533,7 @@ void Manager<TypeListT>::applySystem(void (*system)(ComponentListT& ...), Compon
 			}
 		}
 	};
-	this->applySystemHelper(execute);
+	this->applySystemHelper(SystemRecord{uint64{0}, uint64{0}, execute, "applySystem"});
 }
 
 template <typename TypeListT>
@@ -444,14 +544,306 @@ void Manager<TypeListT>::applySystem(void (*system)(Interface &interface))
 	{
 		for(uint64 i = start; i < stop; i++)
 		{
-			Interface interface(m_entityBuffer[i], i, m_entityFlags[i], m_entityComponents[i]);
+			Interface interface(m_entityBuffer[i], i, m_entityFlags[i], m_entityComponents[i], &m_resources);
 			// for every entity
 			std::invoke(system, interface);
 		}
 	};
-	this->applySystemHelper(execute);
+	this->applySystemHelper(SystemRecord{uint64{0}, uint64{0}, execute, "applySystem"});
+}
+
+template <typename TypeListT>
+template <typename SystemT>
+const uint64 Manager<TypeListT>::registerSystem(
+	SystemT &&system,
+	const std::string &name,
+	const ResourceAccess &resources)
+{
+	m_systems.push_back(this->makeSystemRecord(
+		std::forward<SystemT>(system),
+		static_cast<meta::SystemArguments<SystemT> *>(nullptr)));
+	m_systems.back().name = name.empty() ? ("system #" + std::to_string(m_systems.size() - 1u)) : name;
+	m_systems.back().resources = resources;
+	return m_systems.size() - 1u;
+}
+
+template <typename TypeListT>
+template <typename SystemT>
+JobHandle Manager<TypeListT>::applySystemAsync(SystemT &&system, const CancellationToken &token)
+{
+	auto record = std::make_shared<SystemRecord>(this->makeSystemRecord(
+		std::forward<SystemT>(system),
+		static_cast<meta::SystemArguments<SystemT> *>(nullptr)));
+	record->name = "applySystemAsync";
+	record->order = m_dispatchCount++;
+
+	JobHandle handle = this->dispatchRanges(*record, token);
+	handle.then([record]() { });  // keeps the system alive until all ranges finish
+	return handle;
+}
+
+template <typename TypeListT>
+void Manager<TypeListT>::clearSystems()
+{
+	m_systems.clear();
+}
+
+template <typename TypeListT>
+void Manager<TypeListT>::runSystems()
+{
+	this->flushObservers();  // the frame boundary is the sync point of observers
+
+	// every range of a system waits for all earlier systems the system conflicts with, the rest
+	//   of systems is executed at the same time
+	const auto ranges = this->splitRanges(m_entityCount);
+	JobGraph graph;
+	std::vector<JobGraph::JobID> finished(m_systems.size());  // the joining job of every system
+	for(uint64 current = 0u; current < m_systems.size(); current++)
+	{
+		m_systems[current].order = m_dispatchCount++;
+		std::vector<JobGraph::JobID> dependencies;
+		for(uint64 previous = 0u; previous < current; previous++)
+		{
+			if(m_systems[current].conflictsWith(m_systems[previous]))
+			{
+				dependencies.push_back(finished[previous]);
+			}
+		}
+
+		std::vector<JobGraph::JobID> range_jobs;
+		for(std::size_t index = 0u; index < ranges.size(); index++)
+		{
+			range_jobs.push_back(graph.addJob([this, &system = m_systems[current], range = ranges[index]]()
+			{
+				this->runRange(system, range.first, range.second);
+			}, dependencies, this->rangeNode(index, ranges.size())));
+		}
+		finished[current] = graph.addJob(nullptr, range_jobs);
+	}
+	graph.submit(*m_threadPool, TaskOptions{m_lane}).wait();
 }
 
+template <typename TypeListT>
+template <typename ComponentT, typename CompareT>
+void Manager<TypeListT>::sort(CompareT compare, const SortMode mode)
+{
+	m_componentBuffer.template sort<ComponentT>(compare, mode);
+
+	// entities follow the sorted bucket, the ones without the component are moved behind it
+	const auto &bucket = m_componentBuffer.template getComponentBucket<ComponentT>();
+	std::unordered_map<uint64, uint64> bucket_ranks;
+	bucket_ranks.reserve(bucket.size());
+	for(uint64 index = 0u; index < bucket.size(); index++)
+	{
+		bucket_ranks.emplace(bucket[index].eID(), index);
+	}
+	std::vector<uint64> keys(m_entityBuffer.size());
+	for(std::size_t index = 0u; index < m_entityBuffer.size(); index++)
+	{
+		const auto found = bucket_ranks.find(m_entityBuffer[index]);
+		keys[index] = found != bucket_ranks.end() ? found->second : bucket.size() + index;
+	}
+	const auto order = util::sorted_order(keys.size(), [&keys](const std::size_t lhs, const std::size_t rhs)
+	{
+		return keys[lhs] < keys[rhs];
+	}, mode);
+
+	auto permute = [&order](std::pmr::vector<uint64> &vec)
+	{
+		std::pmr::vector<uint64> result(vec.get_allocator());
+		result.reserve(vec.capacity());
+		for(auto index : order)
+		{
+			result.push_back(vec[index]);
+		}
+		vec.swap(result);
+	};
+	permute(m_entityBuffer);
+	permute(m_entityFlags);
+	permute(m_entityComponents);
+
+	// the remaining buckets follow the new entity order
+	std::unordered_map<uint64, uint64> entity_ranks;
+	entity_ranks.reserve(m_entityBuffer.size());
+	for(uint64 index = 0u; index < m_entityBuffer.size(); index++)
+	{
+		entity_ranks.emplace(m_entityBuffer[index], index);
+	}
+	m_componentBuffer.arrange(entity_ranks, mode);
+}
+
+template <typename TypeListT>
+template <typename... ComponentTs>
+void Manager<TypeListT>::group()
+{
+	m_componentBuffer.template group<ComponentTs...>();
+}
+
+template <typename TypeListT>
+template <typename SystemT>
+void Manager<TypeListT>::applyGroup(SystemT &&system)
+{
+	this->applyGroupHelper(std::forward<SystemT>(system), static_cast<meta::SystemArguments<SystemT> *>(nullptr));
+}
+
+template <typename TypeListT>
+template <typename ResultT, typename MapT, typename CombineT>
+ResultT Manager<TypeListT>::reduce(ResultT init, MapT &&map, CombineT &&combine)
+{
+	return this->reduceHelper(std::move(init), map, combine, static_cast<meta::SystemArguments<MapT> *>(nullptr));
+}
+
+template <typename TypeListT>
+template <typename PredicateT>
+const uint64 Manager<TypeListT>::countIf(PredicateT &&predicate)
+{
+	auto map = [&predicate](auto &...components) { return predicate(components...) ? uint64{1} : uint64{0}; };
+	auto combine = std::plus<uint64>();
+	return this->reduceHelper(uint64{0}, map, combine, static_cast<meta::SystemArguments<PredicateT> *>(nullptr));
+}
+
+template <typename TypeListT>
+template <typename MapT>
+auto Manager<TypeListT>::min(MapT &&map)
+{
+	return this->extremeHelper(map, std::less<>(), static_cast<meta::SystemArguments<MapT> *>(nullptr));
+}
+
+template <typename TypeListT>
+template <typename MapT>
+auto Manager<TypeListT>::max(MapT &&map)
+{
+	return this->extremeHelper(map, std::greater<>(), static_cast<meta::SystemArguments<MapT> *>(nullptr));
+}
+
+template <typename TypeListT>
+Hierarchy &Manager<TypeListT>::getHierarchy() noexcept
+{
+	return m_hierarchy;
+}
+
+template <typename TypeListT>
+Resources &Manager<TypeListT>::getResources() noexcept
+{
+	return m_resources;
+}
+
+template <typename TypeListT>
+template <typename ComponentT, typename FunctionT>
+void Manager<TypeListT>::propagate(FunctionT &&function)
+{
+	const auto &entries = m_hierarchy.order();
+	auto &bucket = m_componentBuffer.template getComponentBucket<ComponentT>();
+
+	// the bucket is left in its order (e.g. the lockstep with entities kept by sort()), components
+	//   are matched to entries by one linear walk if they follow the depth-first order already
+	std::vector<std::size_t> indices(entries.size(), Hierarchy::none);
+	std::size_t matched = 0u;
+	for(std::size_t position = 0u; position < entries.size() && matched < bucket.size(); position++)
+	{
+		if(bucket[matched].eID() == entries[position].entity)
+		{
+			indices[position] = matched++;
+		}
+	}
+	bool complete = true;
+	for(std::size_t index = matched; complete && index < bucket.size(); index++)
+	{
+		complete = !m_hierarchy.contains(bucket[index].eID());
+	}
+	if(!complete)  // any other order is mapped by one lookup table
+	{
+		std::unordered_map<uint64, std::size_t> found;
+		found.reserve(bucket.size());
+		for(std::size_t index = 0u; index < bucket.size(); index++)
+		{
+			found.emplace(bucket[index].eID(), index);
+		}
+		for(std::size_t position = 0u; position < entries.size(); position++)
+		{
+			const auto component = found.find(entries[position].entity);
+			indices[position] = component != found.end() ? component->second : Hierarchy::none;
+		}
+	}
+
+	m_hierarchy.propagate(*m_threadPool, [&entries, &bucket, &indices, &function](const Hierarchy::Entry &entry)
+	{
+		if(entry.parent == Hierarchy::none)
+		{
+			return;
+		}
+		const std::size_t position = static_cast<std::size_t>(&entry - entries.data());
+		const std::size_t child = indices[position];
+		const std::size_t parent = indices[entry.parentIndex];
+		if(child != Hierarchy::none && parent != Hierarchy::none)
+		{
+			function(bucket[child](), std::as_const(bucket[parent]()));
+		}
+	}, TaskOptions{m_lane});
+}
+
+template <typename TypeListT>
+template <typename ComponentT, typename PositionT>
+void Manager<TypeListT>::updateSpatialIndex(SpatialIndex &index, PositionT &&position)
+{
+	const auto &bucket = std::as_const(m_componentBuffer).template getComponentBucket<ComponentT>();
+	index.build(*m_threadPool, bucket.size(), [&bucket, &position](const std::size_t element)
+	{
+		return std::pair<uint64, SpatialIndex::Point>(bucket[element].eID(), position(bucket[element]()));
+	}, TaskOptions{m_lane});
+}
+
+template <typename TypeListT>
+template <typename ComponentT>
+const uint64 Manager<TypeListT>::observe(const ComponentEvent event, ComponentObserver observer)
+{
+	return m_componentBuffer.template observe<ComponentT>(event, std::move(observer));
+}
+
+template <typename TypeListT>
+void Manager<TypeListT>::unobserve(const uint64 observer_id)
+{
+	m_componentBuffer.unobserve(observer_id);
+}
+
+template <typename TypeListT>
+void Manager<TypeListT>::flushObservers()
+{
+	m_componentBuffer.flushObservers();
+}
+
+template <typename TypeListT>
+void Manager<TypeListT>::setNumaPartitioning(const bool enabled) noexcept
+{
+	m_numaPartitioning = enabled;
+}
+
+template <typename TypeListT>
+void Manager<TypeListT>::setDeterministic(const bool enabled, const uint64 chunk_size)
+{
+	if(chunk_size == 0u)
+	{
+		throw std::invalid_argument("Manager::setDeterministic(): the chunk size has to be positive");
+	}
+	m_deterministic = enabled;
+	m_chunkSize = chunk_size;
+	m_componentBuffer.setStableRemoval(enabled);
+}
+
+template <typename TypeListT>
+const bool Manager<TypeListT>::isDeterministic() const noexcept
+{
+	return m_deterministic;
+}
+
+#if ECS_RACE_DETECTOR
+template <typename TypeListT>
+debug::RaceDetector &Manager<TypeListT>::getRaceDetector() noexcept
+{
+	return m_componentBuffer.getRaceDetector();
+}
+#endif
+
 // PRIVATE
 template <typename TypeListT>
 template <uint16 Index>
@@ -476,6 +868,116 @@ void Manager<TypeListT>::addEntityComponents(const uint64 components, const uint
 	}
 }
 
+template <typename TypeListT>
+const uint64 Manager<TypeListT>::addEntitiesFrom(
+	const uint64 components,
+	const uint64 flags,
+	const meta::metautil::TupleOfTypes<TypeListT> &prototypes,
+	const uint64 count)
+{
+	const uint64 first_entity_id = m_nextEntityID;
+	uint64 batch = count;
+	if(m_entityCount + batch > m_maxEntityCount)
+	{
+		batch = m_maxEntityCount - m_entityCount;
+		std::cout << "[WARNING] Number of allocated entities has reached the cap," <<
+			" ignoring the new ones..." << std::endl;
+	}
+
+	// entity ids
+	m_entityBuffer.resize(m_entityCount + batch);
+	std::iota(m_entityBuffer.begin() + m_entityCount, m_entityBuffer.end(), first_entity_id);
+
+	// flags and component bitsets
+	m_entityFlags.insert(m_entityFlags.end(), batch, flags);
+	m_entityComponents.insert(m_entityComponents.end(), batch, components);
+
+	// components
+	this->addEntitiesComponents(
+		std::make_index_sequence<m_componentCount>{},
+		components,
+		first_entity_id,
+		batch,
+		prototypes);
+
+	m_nextEntityID += batch;
+	m_entityCount += batch;
+	return first_entity_id;
+}
+
+template <typename TypeListT>
+template <std::size_t... Indices>
+void Manager<TypeListT>::addEntitiesComponents(
+	std::index_sequence<Indices...>,
+	const uint64 components,
+	const uint64 first_entity_id,
+	const uint64 count,
+	const meta::metautil::TupleOfTypes<TypeListT> &prototypes)
+{
+	auto add = [&](auto &prototype, const uint64 bit)
+	{
+		if((bit & components) == bit)
+		{
+			m_componentBuffer.addComponents(first_entity_id, count, prototype, false);
+		}
+	};
+	(add(std::get<Indices>(prototypes), uint64{1} << Indices), ...);
+	m_componentBuffer.joinGroups(components, first_entity_id, count, true);  // once all owned types are added
+}
+
+template <typename TypeListT>
+template <typename SystemT, typename... ComponentArgs>
+SystemRecord Manager<TypeListT>::makeSystemRecord(
+	SystemT &&system,
+	meta::TypeList<Interface &, ComponentArgs...> *)
+{
+	static_assert((std::is_reference<ComponentArgs>::value && ...), "System's arguments have to be references.");
+	const uint64 bitset = (meta::ComponentBit<ComponentArgs, TypeListT> | ... | uint64{0});
+	auto execute = [bitset, system = std::forward<SystemT>(system), this](const uint64 start, const uint64 stop) mutable
+	{
+		for(uint64 i = start; i < stop; i++)
+		{
+			if((bitset & m_entityComponents[i]) == bitset)  // if tested entity has requested components
+			{
+				Interface interface(m_entityBuffer[i], i, m_entityFlags[i], m_entityComponents[i], &m_resources);
+				std::apply(
+					[&](auto &...components) { system(interface, components...); },
+					this->getMatchingComponentPack<std::remove_reference_t<ComponentArgs>...>(m_entityBuffer[i]));
+			}
+		}
+	};
+	return SystemRecord{
+		(meta::ReadBit<ComponentArgs, TypeListT> | ... | uint64{0}),
+		(meta::WriteBit<ComponentArgs, TypeListT> | ... | uint64{0}),
+		execute,
+		std::string()};
+}
+
+template <typename TypeListT>
+template <typename SystemT, typename... ComponentArgs>
+SystemRecord Manager<TypeListT>::makeSystemRecord(
+	SystemT &&system,
+	meta::TypeList<ComponentArgs...> *)
+{
+	static_assert((std::is_reference<ComponentArgs>::value && ...), "System's arguments have to be references.");
+	const uint64 bitset = (meta::ComponentBit<ComponentArgs, TypeListT> | ... | uint64{0});
+	auto execute = [bitset, system = std::forward<SystemT>(system), this](const uint64 start, const uint64 stop) mutable
+	{
+		for(uint64 i = start; i < stop; i++)
+		{
+			if((bitset & m_entityComponents[i]) == bitset)  // if tested entity has requested components
+			{
+				std::apply(system, this->getMatchingComponentPack<std::remove_reference_t<ComponentArgs>...>(m_entityBuffer[i]));
+			}
+		}
+	};
+	return SystemRecord{
+		(meta::ReadBit<ComponentArgs, TypeListT> | ... | uint64{0}),
+		(meta::WriteBit<ComponentArgs, TypeListT> | ... | uint64{0}),
+		execute,
+		std::string()};
+}
+
 template <typename TypeListT>
 template <typename... ComponentListT>
 auto Manager<TypeListT>::getMatchingComponentPack(const uint64 &entity_id)
@@ -484,34 +986,297 @@ auto Manager<TypeListT>::getMatchingComponentPack(const uint64 &entity_id)
 }
 
 template <typename TypeListT>
-void Manager<TypeListT>::applySystemHelper(std::function<void(const uint64, const uint64)> scheduler)
+template <typename SystemT, typename... ComponentArgs>
+void Manager<TypeListT>::applyGroupHelper(SystemT &&system, meta::TypeList<ComponentArgs...> *)
 {
-	if(m_entityCount > 300)  // should multithreading be applied
+	static_assert((std::is_reference<ComponentArgs>::value && ...), "System's arguments have to be references.");
+	const uint64 size = m_componentBuffer.template groupSize<std::decay_t<ComponentArgs>...>();
+
+	// read-only parameters get const buckets, so the race detector sees them as reads
+	auto bucket = [this](auto *type) -> auto &
 	{
-		// we are splitting indices between threads to make this function more efficient
-		// ex.:
-		// batch = entity_count / thread_count
-		// start_index = i * batch
-		// stop_index = (i + 1) * batch - 1
-		// ex. batch = 3
-		// thread(i): scheduler(start_index, stop_index)
-		// thread(0): scheduler(0, 2)
-		// thread(1): scheduler(3, 5)
-		// thread(11): scheduler(33, 35)
-		auto thread_number = m_threadPool.totalThreadCount();  // number of threads recommended
-		float batch = m_entityCount / static_cast<float>(thread_number);  // number of handled indices per thread
-		for(auto i = 0u; i < thread_number; i++)
+		using ArgumentT = std::remove_pointer_t<decltype(type)>;
+		if constexpr(std::is_const<ArgumentT>::value)
+		{
+			return std::as_const(m_componentBuffer).template getComponentBucket<std::remove_const_t<ArgumentT>>();
+		}
+		else
+		{
+			return m_componentBuffer.template getComponentBucket<ArgumentT>();
+		}
+	};
+	auto execute = [&system, &bucket](const uint64 start, const uint64 stop)
+	{
+		auto buckets = std::forward_as_tuple(bucket(static_cast<std::remove_reference_t<ComponentArgs> *>(nullptr))...);
+		std::apply([&system, start, stop](auto &...vec)
+		{
+			for(uint64 i = start; i < stop; i++)  // members have identical positions in all owned buckets
+			{
+				system(vec[i]()...);
+			}
+		}, buckets);
+	};
+	const SystemRecord record{
+		(meta::ReadBit<ComponentArgs, TypeListT> | ... | uint64{0}),
+		(meta::WriteBit<ComponentArgs, TypeListT> | ... | uint64{0}),
+		execute,
+		"applyGroup"};
+
+	this->runRanges(record, this->splitRanges(size));
+}
+
+template <typename TypeListT>
+template <typename ResultT, typename MapT, typename CombineT, typename... ComponentArgs>
+ResultT Manager<TypeListT>::reduceHelper(ResultT init, MapT &map, CombineT &combine, meta::TypeList<ComponentArgs...> *)
+{
+	static_assert(sizeof... (ComponentArgs) > 0u, "Reductions have to take at least one component.");
+	static_assert((std::is_const<std::remove_reference_t<ComponentArgs>>::value && ...),
+		"Reductions have to take components by const reference.");
+
+	// a single bucket or an owning group is walked directly, other queries check every entity
+	const bool direct = sizeof... (ComponentArgs) == 1u
+		|| m_componentBuffer.template hasGroup<std::decay_t<ComponentArgs>...>();
+	uint64 count = m_entityCount;
+	if constexpr(sizeof... (ComponentArgs) == 1u)
+	{
+		count = std::as_const(m_componentBuffer).template getComponentBucket<std::decay_t<ComponentArgs>...>().size();
+	}
+	else if(direct)
+	{
+		count = m_componentBuffer.template groupSize<std::decay_t<ComponentArgs>...>();
+	}
+	const auto ranges = this->splitRanges(count);
+	std::vector<ResultT> partials(ranges.size(), init);
+
+	auto execute = [&, direct](const uint64 start, const uint64 stop)
+	{
+		ResultT partial = init;
+		if(direct)
+		{
+			auto buckets = std::forward_as_tuple(
+				std::as_const(m_componentBuffer).template getComponentBucket<std::decay_t<ComponentArgs>>()...);
+			std::apply([&](auto &...vec)
+			{
+				for(uint64 i = start; i < stop; i++)
+				{
+					partial = combine(partial, map(vec[i]()...));
+				}
+			}, buckets);
+		}
+		else
 		{
-			m_threadPool.addTask(
-				scheduler,
-				std::lround(i * batch),  // start
-				std::lround((i + 1) * batch - 1));  // stop
+			const uint64 bitset = (meta::ComponentBit<ComponentArgs, TypeListT> | ...);
+			for(uint64 i = start; i < stop; i++)
+			{
+				if((bitset & m_entityComponents[i]) == bitset)
+				{
+					std::apply(
+						[&](auto &...components) { partial = combine(partial, map(components...)); },
+						this->getMatchingComponentPack<std::remove_reference_t<ComponentArgs>...>(m_entityBuffer[i]));
+				}
+			}
 		}
+		const auto range = std::lower_bound(ranges.begin(), ranges.end(), std::make_pair(start, stop));
+		partials[range - ranges.begin()] = std::move(partial);  // every range owns its partial result
+	};
+	this->runRanges(SystemRecord{
+		(meta::ReadBit<ComponentArgs, TypeListT> | ...),
+		uint64{0},
+		execute,
+		"reduce"}, ranges);
+
+	// partial results are combined in the order of ranges, independently of the scheduling
+	ResultT result = std::move(partials.front());
+	for(std::size_t range = 1u; range < partials.size(); range++)
+	{
+		result = combine(result, partials[range]);
+	}
+	return result;
+}
+
+template <typename TypeListT>
+template <typename MapT, typename CompareT, typename... ComponentArgs>
+auto Manager<TypeListT>::extremeHelper(MapT &map, CompareT compare, meta::TypeList<ComponentArgs...> *)
+{
+	using ValueT = std::decay_t<std::invoke_result_t<MapT &, ComponentArgs...>>;
+	auto wrapped = [&map](ComponentArgs ...components) { return std::optional<ValueT>(map(components...)); };
+	auto combine = [&compare](const std::optional<ValueT> &lhs, const std::optional<ValueT> &rhs)
+	{
+		// ties keep the earlier value, so the result is deterministic
+		return (!lhs || (rhs && compare(*rhs, *lhs))) ? rhs : lhs;
+	};
+	return this->reduceHelper(
+		std::optional<ValueT>(),
+		wrapped,
+		combine,
+		static_cast<meta::TypeList<ComponentArgs...> *>(nullptr));
+}
+
+template <typename TypeListT>
+void Manager<TypeListT>::runRanges(SystemRecord system, const std::vector<std::pair<uint64, uint64>> &ranges)
+{
+	system.order = m_dispatchCount++;
+	if(ranges.size() == 1u)
+	{
+		this->runRange(system, ranges.front().first, ranges.front().second);
+		return;
+	}
+	JobGraph graph;
+	for(std::size_t index = 0u; index < ranges.size(); index++)
+	{
+		graph.addJob([this, &system, range = ranges[index]]()
+		{
+			this->runRange(system, range.first, range.second);
+		}, {}, this->rangeNode(index, ranges.size()));
+	}
+	graph.submit(*m_threadPool, TaskOptions{m_lane}).wait();
+}
+
+template <typename TypeListT>
+void Manager<TypeListT>::applySystemHelper(SystemRecord system)
+{
+	system.order = m_dispatchCount++;
+	if(m_entityCount > 300 && m_threadPool->totalThreadCount() > 0u)  // should multithreading be applied
+	{
+		// systems capture local state by reference, so all ranges have to finish before returning
+		this->dispatchRanges(system).wait();
 	}
 	else  // there are too few entities to have multithreading more performant
 	{
-		scheduler(uint64{0}, m_entityCount);
+		this->runRange(system, uint64{0}, m_entityCount);
+	}
+}
+
+template <typename TypeListT>
+JobHandle Manager<TypeListT>::dispatchRanges(const SystemRecord &system, const CancellationToken &token)
+{
+	if(m_threadPool->totalThreadCount() == 0u)  // nobody would execute the ranges
+	{
+		if(!token.isCancelled())
+		{
+			this->runRange(system, uint64{0}, m_entityCount);
+		}
+		return JobHandle();
+	}
+
+	const auto ranges = this->splitRanges(m_entityCount);
+	JobHandle handle(static_cast<unsigned>(ranges.size()));
+	// the token is checked by ranges instead of the pool, dropped tasks would never complete the handle
+	auto run_range = [&system, &token, handle, this](const uint64 start, const uint64 stop)
+	{
+		return [&system, token, handle, start, stop, this](const int)
+		{
+			try
+			{
+				if(!token.isCancelled())
+				{
+					this->runRange(system, start, stop);
+				}
+			}
+			catch(...)
+			{
+				handle.completeTask();
+				throw;  // stored in the future attached to the handle
+			}
+			handle.completeTask();
+		};
+	};
+
+	// ranges of one node are added at once, so the queue is locked and threads are woken up once
+	for(std::size_t first = 0u; first < ranges.size(); )
+	{
+		const unsigned node = this->rangeNode(first, ranges.size());
+		std::vector<decltype(run_range(0u, 0u))> tasks;
+		std::size_t last = first;
+		for(; last < ranges.size() && this->rangeNode(last, ranges.size()) == node; last++)
+		{
+			tasks.push_back(run_range(ranges[last].first, ranges[last].second));
+		}
+		auto results = m_threadPool->addTasks(std::move(tasks), TaskOptions{m_lane, node});
+		if(results.empty())  // the pool is halted, the calling thread runs ranges itself
+		{
+			for(std::size_t index = first; index < last; index++)
+			{
+				run_range(ranges[index].first, ranges[index].second)(0);
+			}
+		}
+		first = last;
+		for(auto &result : results)
+		{
+			handle.attach(std::move(result));
+		}
+	}
+	return handle;
+}
+
+template <typename TypeListT>
+std::vector<std::pair<uint64, uint64>> Manager<TypeListT>::splitRanges(const uint64 count) const
+{
+	// we are splitting indices between threads to make systems more efficient
+	// ex.:
+	// batch = entity_count / thread_count
+	// start_index = i * batch
+	// stop_index = (i + 1) * batch  (exclusive)
+	// ex. batch = 3
+	// thread(i): system(start_index, stop_index)
+	// thread(0): system(0, 3)
+	// thread(1): system(3, 6)
+	// thread(11): system(33, 36)
+	// too few entities are handled by one range, so that it can run in parallel with other systems
+	if(m_deterministic)  // fixed chunks do not depend on the thread count
+	{
+		const uint64 chunk_count = std::max(uint64{1}, (count + m_chunkSize - 1u) / m_chunkSize);
+		std::vector<std::pair<uint64, uint64>> chunks;
+		chunks.reserve(chunk_count);
+		for(uint64 chunk = 0u; chunk < chunk_count; chunk++)
+		{
+			chunks.emplace_back(chunk * m_chunkSize, std::min(count, (chunk + 1u) * m_chunkSize));
+		}
+		return chunks;
+	}
+	const unsigned thread_number = (count > 300 && m_threadPool->totalThreadCount() > 0u)
+		? m_threadPool->totalThreadCount() : 1u;
+	const float batch = count / static_cast<float>(thread_number);  // number of handled indices per thread
+	std::vector<std::pair<uint64, uint64>> ranges;
+	ranges.reserve(thread_number);
+	for(auto i = 0u; i < thread_number; i++)
+	{
+		ranges.emplace_back(std::lround(i * batch), std::lround((i + 1) * batch));
+	}
+	return ranges;
+}
+
+template <typename TypeListT>
+const unsigned Manager<TypeListT>::rangeNode(const std::size_t index, const std::size_t count) const
+{
+	if(!m_numaPartitioning)
+	{
+		return TaskOptions::anyNode;
+	}
+	// consecutive ranges are given to consecutive nodes, so every node works on one slice of buckets
+	return static_cast<unsigned>(index * m_threadPool->nodeCount() / count);
+}
+
+template <typename TypeListT>
+void Manager<TypeListT>::runRange(const SystemRecord &system, const uint64 start, const uint64 stop)
+{
+	const impl::EmitScope scope(impl::EmitKey{system.order, start});  // orders events of ordered channels
+#if ECS_RACE_DETECTOR
+	auto &detector = m_componentBuffer.getRaceDetector();
+	detector.beginSystem(&system, system.name, system.reads, system.writes);
+	try
+	{
+		system.execute(start, stop);
+	}
+	catch(...)
+	{
+		detector.endSystem();
+		throw;
 	}
+	detector.endSystem();
+#else
+	system.execute(start, stop);
+#endif
 }
 
 }  // namespace ecs
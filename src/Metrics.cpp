@@ -0,0 +1,149 @@
+#include "../include/Metrics.h"
+
+namespace ecs
+{
+
+// buckets 0-3 hold values 0-3, then every power of two 2^k (k >= 2) is split into 4 buckets of
+//   width 2^(k-2), starting at index 4 * (k - 1)
+const std::size_t LatencyHistogram::bucketOf(const uint64 nanoseconds) noexcept
+{
+	if(nanoseconds < 4u)
+	{
+		return static_cast<std::size_t>(nanoseconds);
+	}
+	const unsigned octave = 63u - static_cast<unsigned>(__builtin_clzll(nanoseconds));
+	const unsigned sub_bucket = static_cast<unsigned>(nanoseconds >> (octave - 2u)) & 3u;
+	return 4u * (octave - 1u) + sub_bucket;
+}
+
+const uint64 LatencyHistogram::upperBound(const std::size_t bucket) noexcept
+{
+	if(bucket < 4u)
+	{
+		return static_cast<uint64>(bucket);
+	}
+	const unsigned octave = static_cast<unsigned>(bucket / 4u) + 1u;
+	const uint64 sub_bucket = bucket % 4u;
+	const uint64 lower = (uint64{4} + sub_bucket) << (octave - 2u);
+	return lower + ((uint64{1} << (octave - 2u)) - 1u);
+}
+
+void LatencyHistogram::record(const std::chrono::nanoseconds duration) noexcept
+{
+	const uint64 value = duration.count() > 0 ? static_cast<uint64>(duration.count()) : 0u;
+	m_buckets[LatencyHistogram::bucketOf(value)]++;
+	m_count++;
+}
+
+LatencyHistogram &LatencyHistogram::merge(const LatencyHistogram &other) noexcept
+{
+	for(std::size_t bucket = 0u; bucket < bucketCount; bucket++)
+	{
+		m_buckets[bucket] += other.m_buckets[bucket];
+	}
+	m_count += other.m_count;
+	return *this;
+}
+
+const uint64 LatencyHistogram::count() const noexcept
+{
+	return m_count;
+}
+
+const std::chrono::nanoseconds LatencyHistogram::percentile(const double fraction) const noexcept
+{
+	if(m_count == 0u)
+	{
+		return std::chrono::nanoseconds(0);
+	}
+	const double clamped = std::min(1.0, std::max(0.0, fraction));
+	const uint64 rank = std::max<uint64>(1u, static_cast<uint64>(std::ceil(clamped * m_count)));
+	uint64 seen = 0u;
+	for(std::size_t bucket = 0u; bucket < bucketCount; bucket++)
+	{
+		seen += m_buckets[bucket];
+		if(seen >= rank)
+		{
+			return std::chrono::nanoseconds(static_cast<int64>(LatencyHistogram::upperBound(bucket)));
+		}
+	}
+	return std::chrono::nanoseconds(static_cast<int64>(LatencyHistogram::upperBound(bucketCount - 1u)));
+}
+
+const uint64 LatencyHistogram::bucketCountAt(const std::size_t bucket) const
+{
+	return m_buckets.at(bucket);
+}
+
+void LatencyHistogram::setBucketCount(const std::size_t bucket, const uint64 count)
+{
+	m_count = m_count - m_buckets.at(bucket) + count;
+	m_buckets[bucket] = count;
+}
+
+const double WorkerMetrics::utilization() const noexcept
+{
+	const auto total = busyTime + idleTime;
+	return total.count() > 0 ? static_cast<double>(busyTime.count()) / total.count() : 0.0;
+}
+
+WorkerMetrics PoolMetrics::total() const
+{
+	WorkerMetrics result;
+	for(const auto &worker : workers)
+	{
+		result.tasksExecuted += worker.tasksExecuted;
+		result.steals += worker.steals;
+		result.tasksDropped += worker.tasksDropped;
+		result.busyTime += worker.busyTime;
+		result.idleTime += worker.idleTime;
+		result.queueLatency.merge(worker.queueLatency);
+		result.taskDuration.merge(worker.taskDuration);
+	}
+	return result;
+}
+
+namespace impl
+{
+
+void WorkerCounters::record(
+	std::array<std::atomic<uint64>, LatencyHistogram::bucketCount> &histogram,
+	const std::chrono::nanoseconds duration) noexcept
+{
+	const uint64 value = duration.count() > 0 ? static_cast<uint64>(duration.count()) : 0u;
+	histogram[LatencyHistogram::bucketOf(value)].fetch_add(1u, std::memory_order_relaxed);
+}
+
+WorkerMetrics WorkerCounters::snapshot() const
+{
+	WorkerMetrics result;
+	result.tasksExecuted = tasksExecuted.load(std::memory_order_relaxed);
+	result.steals = steals.load(std::memory_order_relaxed);
+	result.tasksDropped = tasksDropped.load(std::memory_order_relaxed);
+	result.busyTime = std::chrono::nanoseconds(busyNanoseconds.load(std::memory_order_relaxed));
+	result.idleTime = std::chrono::nanoseconds(idleNanoseconds.load(std::memory_order_relaxed));
+	for(std::size_t bucket = 0u; bucket < LatencyHistogram::bucketCount; bucket++)
+	{
+		result.queueLatency.setBucketCount(bucket, queueLatency[bucket].load(std::memory_order_relaxed));
+		result.taskDuration.setBucketCount(bucket, taskDuration[bucket].load(std::memory_order_relaxed));
+	}
+	return result;
+}
+
+void WorkerCounters::reset() noexcept
+{
+	tasksExecuted = 0u;
+	steals = 0u;
+	tasksDropped = 0u;
+	busyNanoseconds = 0u;
+	idleNanoseconds = 0u;
+	for(std::size_t bucket = 0u; bucket < LatencyHistogram::bucketCount; bucket++)
+	{
+		queueLatency[bucket] = 0u;
+		taskDuration[bucket] = 0u;
+	}
+}
+
+}  // namespace impl
+
+}  // namespace ecs
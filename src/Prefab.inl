@@ -0,0 +1,48 @@
+namespace ecs
+{
+
+template <typename... Typepack>
+Prefab<meta::TypeList<Typepack...>>::Prefab(const uint64 flags)
+:
+m_prototypes(),
+m_components(uint64{0}),
+m_flags(flags)
+{ }
+
+template <typename... Typepack>
+template <typename ComponentT>
+Prefab<meta::TypeList<Typepack...>> &Prefab<meta::TypeList<Typepack...>>::set(const ComponentT &component)
+{
+	static_assert(meta::DoesTypeExist<ComponentT, m_tPool>, "There's no such component in ComponentPool.");
+	std::get<meta::IndexOf<ComponentT, m_tPool>>(m_prototypes) = component;
+	m_components |= (uint64{1} << meta::IndexOf<ComponentT, m_tPool>);
+	return *this;
+}
+
+template <typename... Typepack>
+template <typename ComponentT>
+const ComponentT &Prefab<meta::TypeList<Typepack...>>::get() const
+{
+	static_assert(meta::DoesTypeExist<ComponentT, m_tPool>, "There's no such component in ComponentPool.");
+	return std::get<meta::IndexOf<ComponentT, m_tPool>>(m_prototypes);
+}
+
+template <typename... Typepack>
+const std::tuple<Typepack...> &Prefab<meta::TypeList<Typepack...>>::prototypes() const noexcept
+{
+	return m_prototypes;
+}
+
+template <typename... Typepack>
+const uint64 &Prefab<meta::TypeList<Typepack...>>::components() const noexcept
+{
+	return m_components;
+}
+
+template <typename... Typepack>
+const uint64 &Prefab<meta::TypeList<Typepack...>>::flags() const noexcept
+{
+	return m_flags;
+}
+
+}  // namespace ecs
@@ -0,0 +1,143 @@
+#include "../include/RaceDetector.h"
+
+namespace ecs
+{
+namespace debug
+{
+
+RaceDetector::RaceDetector(std::vector<std::string> component_names)
+:
+m_componentNames(std::move(component_names)),
+m_regions(),
+m_reports(),
+m_reported(),
+m_mutex()
+{ }
+
+void RaceDetector::beginSystem(const void *system, const std::string &name, const uint64 reads, const uint64 writes)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for(const auto &[thread, stack] : m_regions)
+	{
+		const Region &region = stack.back();  // outer regions wait for the innermost one
+		if(thread == std::this_thread::get_id())  // the system waited in is suspended until this one ends
+		{
+			continue;
+		}
+		if(region.system == system)  // ranges of the same system touch different entities
+		{
+			continue;
+		}
+		const uint64 overlapping_writes = writes & region.writes;
+		const uint64 read_write = (reads & region.writes) | (writes & region.reads);
+		if(overlapping_writes || read_write)
+		{
+			std::stringstream message;
+			message << "system '" << name << "' [thread " << std::this_thread::get_id()
+				<< "] started while system '" << region.name << "' [thread " << thread << "] is running: ";
+			if(overlapping_writes)
+			{
+				message << "overlapping writes of " << this->componentNames(overlapping_writes);
+			}
+			if(read_write)
+			{
+				message << (overlapping_writes ? ", " : "") << "read/write conflict on "
+					<< this->componentNames(read_write);
+			}
+			this->report(message.str());
+		}
+	}
+	m_regions[std::this_thread::get_id()].push_back(Region{system, name, reads, writes});
+}
+
+void RaceDetector::endSystem()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto current = m_regions.find(std::this_thread::get_id());
+	if(current == m_regions.end())
+	{
+		return;
+	}
+	current->second.pop_back();  // the system run by a helping wait() returns to the outer one
+	if(current->second.empty())
+	{
+		m_regions.erase(current);
+	}
+}
+
+void RaceDetector::recordAccess(const uint16 component, const Access access)
+{
+	const uint64 bit = uint64{1} << component;
+	const char *access_name = (access == Access::Read) ? "read" : "write";
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto current = m_regions.find(std::this_thread::get_id());
+	if(current != m_regions.end())  // the thread executes a system, validate its declaration
+	{
+		const Region &region = current->second.back();
+		const uint64 declared = (access == Access::Read) ? (region.reads | region.writes) : region.writes;
+		if(!(declared & bit))
+		{
+			std::stringstream message;
+			message << "system '" << region.name << "' [thread " << std::this_thread::get_id()
+				<< "] performs undeclared " << access_name << " of " << this->componentNames(bit);
+			this->report(message.str());
+		}
+	}
+	else  // access from outside of systems cannot touch anything used by running systems
+	{
+		for(const auto &[thread, stack] : m_regions)
+		{
+			const Region &region = stack.back();
+			const uint64 conflicting = (access == Access::Read) ? region.writes : (region.reads | region.writes);
+			if(conflicting & bit)
+			{
+				std::stringstream message;
+				message << "unscheduled " << access_name << " of " << this->componentNames(bit)
+					<< " [thread " << std::this_thread::get_id() << "] while system '" << region.name
+					<< "' [thread " << thread << "] is running";
+				this->report(message.str());
+			}
+		}
+	}
+}
+
+std::vector<std::string> RaceDetector::reports() const
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_reports;
+}
+
+void RaceDetector::clearReports()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_reports.clear();
+	m_reported.clear();
+}
+
+std::string RaceDetector::componentNames(const uint64 bitset) const
+{
+	std::string result;
+	for(uint16 index = 0u; index < 64u; index++)
+	{
+		if(bitset & (uint64{1} << index))
+		{
+			result += result.empty() ? "" : ", ";
+			result += (index < m_componentNames.size()) ? m_componentNames[index] : "#" + std::to_string(index);
+		}
+	}
+	return "(" + result + ")";
+}
+
+void RaceDetector::report(const std::string &message)
+{
+	if(!m_reported.insert(message).second)  // every distinct report is stored once
+	{
+		return;
+	}
+	std::cerr << "[RACE] " << message << std::endl;
+	m_reports.push_back(message);
+}
+
+}  // namespace debug
+}  // namespace ecs
@@ -0,0 +1,44 @@
+#include "../include/Resources.h"
+
+namespace ecs
+{
+
+namespace impl
+{
+
+std::size_t nextResourceIndex() noexcept
+{
+	static std::atomic<std::size_t> next{0u};
+	return next++;
+}
+
+}  // namespace impl
+
+void Resources::clear() noexcept
+{
+	m_resources.clear();
+}
+
+const bool ResourceAccess::conflictsWith(const ResourceAccess &other) const noexcept
+{
+	return ResourceAccess::intersects(m_writes, other.m_reads)
+		|| ResourceAccess::intersects(m_writes, other.m_writes)
+		|| ResourceAccess::intersects(other.m_writes, m_reads);
+}
+
+const bool ResourceAccess::intersects(const std::vector<std::size_t> &lhs, const std::vector<std::size_t> &rhs) noexcept
+{
+	auto left = lhs.begin();
+	auto right = rhs.begin();
+	while(left != lhs.end() && right != rhs.end())
+	{
+		if(*left == *right)
+		{
+			return true;
+		}
+		*left < *right ? left++ : right++;
+	}
+	return false;
+}
+
+}  // namespace ecs
@@ -0,0 +1,69 @@
+namespace ecs
+{
+
+template <typename ResourceT, typename... Args>
+ResourceT &Resources::emplace(Args &&...args)
+{
+	const std::size_t index = impl::resourceIndex<ResourceT>();
+	if(index >= m_resources.size())
+	{
+		m_resources.resize(index + 1u);
+	}
+	auto resource = std::make_shared<ResourceT>(std::forward<Args>(args)...);
+	ResourceT &result = *resource;
+	m_resources[index] = std::move(resource);
+	return result;
+}
+
+template <typename ResourceT>
+ResourceT &Resources::get()
+{
+	ResourceT *resource = this->find<ResourceT>();
+	if(resource == nullptr)
+	{
+		throw std::out_of_range(
+			"template <typename ResourceT> ResourceT &Resources::get(): There is no such resource.");
+	}
+	return *resource;
+}
+
+template <typename ResourceT>
+const ResourceT &Resources::get() const
+{
+	return const_cast<Resources *>(this)->get<ResourceT>();
+}
+
+template <typename ResourceT>
+ResourceT *Resources::find() const noexcept
+{
+	const std::size_t index = impl::resourceIndex<ResourceT>();
+	return index < m_resources.size() ? static_cast<ResourceT *>(m_resources[index].get()) : nullptr;
+}
+
+template <typename ResourceT>
+void Resources::remove() noexcept
+{
+	const std::size_t index = impl::resourceIndex<ResourceT>();
+	if(index < m_resources.size())
+	{
+		m_resources[index].reset();
+	}
+}
+
+template <typename... ResourceTs>
+ResourceAccess &ResourceAccess::reads()
+{
+	(m_reads.push_back(impl::resourceIndex<ResourceTs>()), ...);
+	std::sort(m_reads.begin(), m_reads.end());
+	return *this;
+}
+
+template <typename... ResourceTs>
+ResourceAccess &ResourceAccess::writes()
+{
+	(m_writes.push_back(impl::resourceIndex<ResourceTs>()), ...);
+	std::sort(m_writes.begin(), m_writes.end());
+	return *this;
+}
+
+}  // namespace ecs
@@ -0,0 +1,227 @@
+#include "../include/SpatialIndex.h"
+
+namespace ecs
+{
+
+SpatialIndex::SpatialIndex(const float cell_size)
+:
+m_cellSize(cell_size),
+m_inverseCellSize(1.f / cell_size),
+m_bucketStart(2u, 0u)
+{
+	if(!(cell_size > 0.f))
+	{
+		throw std::invalid_argument("SpatialIndex::SpatialIndex(): the cell size has to be positive");
+	}
+}
+
+void SpatialIndex::build(
+	ThreadPool &pool,
+	const std::size_t count,
+	const std::function<std::pair<uint64, Point>(const std::size_t index)> &fetch,
+	const TaskOptions &options)
+{
+	std::size_t bucket_count = 1u;
+	while(bucket_count < count)  // about one entity per bucket keeps hash collisions rare
+	{
+		bucket_count <<= 1;
+	}
+	m_bucketMask = bucket_count - 1u;
+
+	// counting sort: ranges count into shared buckets, slices of buckets sum them up, ranges
+	//   scatter and slices restore the input order inside their buckets (memory stays O(n))
+	const std::size_t range_count = (count > 1000u && pool.totalThreadCount() > 0u) ? pool.totalThreadCount() : 1u;
+	std::vector<uint64> entities(count);
+	std::vector<Point> points(count);
+	std::vector<std::size_t> buckets(count);
+	std::vector<std::size_t> sorted(count);
+	std::vector<std::atomic<std::size_t>> cursors(bucket_count);
+	std::vector<std::size_t> slice_totals(range_count, 0u);
+	m_entities.resize(count);
+	m_points.resize(count);
+	m_bucketStart.assign(bucket_count + 1u, 0u);
+	m_bucketStart[bucket_count] = count;
+
+	JobGraph graph;
+	auto add_jobs = [&graph, range_count](const std::size_t size, const std::vector<JobGraph::JobID> &dependencies, auto body)
+	{
+		std::vector<JobGraph::JobID> jobs;
+		for(std::size_t range = 0u; range < range_count; range++)
+		{
+			const std::size_t first = size * range / range_count;
+			const std::size_t last = size * (range + 1u) / range_count;
+			jobs.push_back(graph.addJob([body, range, first, last]() { body(range, first, last); }, dependencies));
+		}
+		return jobs;
+	};
+	const auto counting = add_jobs(count, {}, [&](const std::size_t, const std::size_t first, const std::size_t last)
+	{
+		for(std::size_t index = first; index < last; index++)
+		{
+			std::tie(entities[index], points[index]) = fetch(index);
+			buckets[index] = this->bucketOf(this->cellOf(points[index]));
+			cursors[buckets[index]].fetch_add(1u, std::memory_order_relaxed);
+		}
+	});
+	const auto summing = add_jobs(bucket_count, counting, [&](const std::size_t slice, const std::size_t first, const std::size_t last)
+	{
+		std::size_t total = 0u;
+		for(std::size_t bucket = first; bucket < last; bucket++)
+		{
+			total += cursors[bucket].load(std::memory_order_relaxed);
+		}
+		slice_totals[slice] = total;
+	});
+	const auto scanning = add_jobs(bucket_count, summing, [&](const std::size_t slice, const std::size_t first, const std::size_t last)
+	{
+		std::size_t total = std::accumulate(slice_totals.begin(), slice_totals.begin() + slice, std::size_t{0});
+		for(std::size_t bucket = first; bucket < last; bucket++)
+		{
+			m_bucketStart[bucket] = total;
+			total += cursors[bucket].exchange(m_bucketStart[bucket], std::memory_order_relaxed);
+		}
+	});
+	const auto scattering = add_jobs(count, scanning, [&](const std::size_t, const std::size_t first, const std::size_t last)
+	{
+		for(std::size_t index = first; index < last; index++)
+		{
+			sorted[cursors[buckets[index]].fetch_add(1u, std::memory_order_relaxed)] = index;
+		}
+	});
+	add_jobs(bucket_count, scattering, [&](const std::size_t, const std::size_t first, const std::size_t last)
+	{
+		// buckets hold about one entry, so sorting them keeps the result deterministic for free
+		for(std::size_t bucket = first; bucket < last; bucket++)
+		{
+			const auto begin = sorted.begin() + m_bucketStart[bucket];
+			const auto end = sorted.begin() + m_bucketStart[bucket + 1u];
+			std::sort(begin, end);
+			for(auto entry = begin; entry != end; entry++)
+			{
+				const auto position = static_cast<std::size_t>(entry - sorted.begin());
+				m_entities[position] = entities[*entry];
+				m_points[position] = points[*entry];
+			}
+		}
+	});
+	graph.submit(pool, options).wait();
+}
+
+Span<const uint64> SpatialIndex::queryRadius(const Point &center, const float radius, std::vector<uint64> &result) const
+{
+	result.clear();
+	const float squared = radius * radius;
+	this->collect(
+		Point{center[0] - radius, center[1] - radius, center[2] - radius},
+		Point{center[0] + radius, center[1] + radius, center[2] + radius},
+		[&center, squared](const Point &point)
+		{
+			const float dx = point[0] - center[0];
+			const float dy = point[1] - center[1];
+			const float dz = point[2] - center[2];
+			return dx * dx + dy * dy + dz * dz <= squared;
+		},
+		result);
+	return Span<const uint64>(result.data(), result.size());
+}
+
+Span<const uint64> SpatialIndex::queryBox(const Point &min, const Point &max, std::vector<uint64> &result) const
+{
+	result.clear();
+	this->collect(min, max, [&min, &max](const Point &point)
+	{
+		return point[0] >= min[0] && point[0] <= max[0]
+			&& point[1] >= min[1] && point[1] <= max[1]
+			&& point[2] >= min[2] && point[2] <= max[2];
+	}, result);
+	return Span<const uint64>(result.data(), result.size());
+}
+
+const std::size_t SpatialIndex::size() const noexcept
+{
+	return m_entities.size();
+}
+
+const float SpatialIndex::cellSize() const noexcept
+{
+	return m_cellSize;
+}
+
+// PRIVATE
+
+const SpatialIndex::Cell SpatialIndex::cellOf(const Point &point) const noexcept
+{
+	// NaN goes to the cell 0 and huge values to the outermost cells, so the cast stays defined
+	static constexpr double limit = 4611686018427387904.0;  // 2^62
+	auto coordinate = [this](const float value)
+	{
+		const double scaled = std::floor(value * m_inverseCellSize);
+		return static_cast<int64>(std::isnan(scaled) ? 0.0 : std::min(limit, std::max(-limit, scaled)));
+	};
+	return Cell{coordinate(point[0]), coordinate(point[1]), coordinate(point[2])};
+}
+
+const std::size_t SpatialIndex::bucketOf(const Cell &cell) const noexcept
+{
+	const uint64 hash = (static_cast<uint64>(cell[0]) * uint64{73856093})
+		^ (static_cast<uint64>(cell[1]) * uint64{19349663})
+		^ (static_cast<uint64>(cell[2]) * uint64{83492791});
+	return static_cast<std::size_t>(hash) & m_bucketMask;
+}
+
+template <typename TestT>
+void SpatialIndex::collect(const Point &min, const Point &max, TestT test, std::vector<uint64> &result) const
+{
+	for(std::size_t axis = 0u; axis < 3u; axis++)
+	{
+		// an inverted box (e.g. a negative radius) is empty, NaN fails the comparison as well
+		if(!std::isfinite(min[axis]) || !std::isfinite(max[axis]) || !(min[axis] <= max[axis]))
+		{
+			return;
+		}
+	}
+	const Cell low = this->cellOf(min);
+	const Cell high = this->cellOf(max);
+	double cell_count = 1.0;
+	for(std::size_t axis = 0u; axis < 3u; axis++)
+	{
+		cell_count *= static_cast<double>(high[axis]) - static_cast<double>(low[axis]) + 1.0;
+	}
+
+	// different cells may share a bucket, so every bucket is visited once
+	std::vector<std::size_t> buckets;
+	if(cell_count > static_cast<double>(m_bucketMask))  // the box covers the table anyway
+	{
+		buckets.resize(m_bucketMask + 1u);
+		std::iota(buckets.begin(), buckets.end(), std::size_t{0});
+	}
+	else
+	{
+		buckets.reserve(static_cast<std::size_t>(cell_count));
+		for(int64 x = low[0]; x <= high[0]; x++)
+		{
+			for(int64 y = low[1]; y <= high[1]; y++)
+			{
+				for(int64 z = low[2]; z <= high[2]; z++)
+				{
+					buckets.push_back(this->bucketOf(Cell{x, y, z}));
+				}
+			}
+		}
+		std::sort(buckets.begin(), buckets.end());
+		buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+	}
+
+	for(auto bucket : buckets)
+	{
+		for(std::size_t entry = m_bucketStart[bucket]; entry < m_bucketStart[bucket + 1u]; entry++)
+		{
+			if(test(m_points[entry]))
+			{
+				result.push_back(m_entities[entry]);
+			}
+		}
+	}
+}
+
+}  // namespace ecs
@@ -0,0 +1,12 @@
+#include "../include/System.h"
+
+namespace ecs
+{
+
+const bool SystemRecord::conflictsWith(const SystemRecord &other) const noexcept
+{
+	return (writes & (other.reads | other.writes)) || (other.writes & (reads | writes))
+		|| resources.conflictsWith(other.resources);
+}
+
+}  // namespace ecs
@@ -1,5 +1,10 @@
 #pragma once
 
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
 namespace ecs
 {
 
@@ -96,28 +101,200 @@ inline const T &SafeQueue<T>::back() const
 	return m_queue.back();
 }
 
+template <typename T>
+inline const bool LaneQueue<T>::push(const T &value, const unsigned lane, const unsigned level)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto &lanes = m_levels[level].lanes;
+	if(lane >= lanes.size())
+	{
+		lanes.resize(lane + 1u);
+	}
+	lanes[lane].push(value);
+	m_sizes[level]++;
+	return true;
+}
+
+template <typename T>
+template <typename Iterator>
+inline const bool LaneQueue<T>::push(Iterator first, Iterator last, const unsigned lane, const unsigned level)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto &lanes = m_levels[level].lanes;
+	if(lane >= lanes.size())
+	{
+		lanes.resize(lane + 1u);
+	}
+	for(; first != last; ++first)
+	{
+		lanes[lane].push(*first);
+		m_sizes[level]++;
+	}
+	return true;
+}
+
+template <typename T>
+inline const bool LaneQueue<T>::pop(T &value)
+{
+	for(unsigned level = 0u; level < levelCount; level++)
+	{
+		if(this->pop(value, level))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename T>
+inline const bool LaneQueue<T>::pop(T &value, const unsigned level)
+{
+	if(m_sizes[level] == 0u)  // don't lock the queue only to find out it's empty
+	{
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if(m_sizes[level] == 0u)
+	{
+		return false;
+	}
+	// look for the next non-empty lane, starting from the one after the previously served
+	auto &current = m_levels[level];
+	while(true)
+	{
+		auto &lane = current.lanes[current.cursor];
+		current.cursor = (current.cursor + 1u) % current.lanes.size();
+		if(!lane.empty())
+		{
+			value = lane.front();
+			lane.pop();
+			m_sizes[level]--;
+			return true;
+		}
+	}
+}
+
+template <typename T>
+template <typename PredicateT>
+inline const bool LaneQueue<T>::popIf(T &value, const unsigned level, PredicateT accept)
+{
+	if(m_sizes[level] == 0u)
+	{
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto &current = m_levels[level];
+	for(std::size_t visited = 0u; visited < current.lanes.size(); visited++)
+	{
+		auto &lane = current.lanes[current.cursor];
+		current.cursor = (current.cursor + 1u) % current.lanes.size();
+		if(!lane.empty() && accept(lane.front()))
+		{
+			value = lane.front();
+			lane.pop();
+			m_sizes[level]--;
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename T>
+inline const bool LaneQueue<T>::empty()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for(unsigned level = 0u; level < levelCount; level++)
+	{
+		if(m_sizes[level] != 0u)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+inline const bool LaneQueue<T>::empty(const unsigned level) const noexcept
+{
+	return m_sizes[level] == 0u;
+}
+
+inline const bool Task::expired() const
+{
+	return token.isCancelled()
+		|| (deadline != std::chrono::steady_clock::time_point() && std::chrono::steady_clock::now() > deadline);
+}
+
 }  // namespace impl
 
-ThreadPool::ThreadPool(const unsigned thread_count)
+inline const bool TaskOptions::expired() const
+{
+	return token.isCancelled()
+		|| (deadline != std::chrono::steady_clock::time_point() && std::chrono::steady_clock::now() > deadline);
+}
+
+inline ThreadPool::ThreadPool(const unsigned thread_count, std::pmr::memory_resource *resource)
 :
+m_allocator(resource),
 m_threads(),
 m_abortFlags(),
+m_threadNodes(),
+m_workerCounters(),
+m_metricsEnabled(false),
 m_queue(),
+m_nodeQueues(),
+m_affinityPolicy(AffinityPolicy::None),
+m_topology(CpuTopology::system()),
 m_finishedFlag(false),
 m_haltFlag(false),
 m_infHaltFlag(false),
 m_waitingThreadsCount(0u),
-m_pendingTasksCount(0u)
+m_spinCount(0u),
+m_yieldCount(0u),
+m_activeFrames(0u),
+m_backgroundThreadsCount(0u),
+m_backgroundThreadLimit(0u),
+m_pendingTasksCount(0u),
+m_laneCount(1u),
+m_freeLanes(),
+m_laneMutex(),
+m_timerHeap(),
+m_timers(),
+m_nextTimerID(1u),
+m_timerStop(false),
+m_timerThread()
 {
+	for(unsigned node = 0u; node < m_topology.nodeCount(); node++)
+	{
+		m_nodeQueues.emplace_back(new impl::LaneQueue<impl::Task *>());
+	}
 	this->resize(thread_count);
 }
 
-ThreadPool::~ThreadPool()
+inline ThreadPool::~ThreadPool()
 {
 	this->halt(true);  // terminate immediately, but first wait for threads to finish their tasks
 	this->haltInfinite();
 }
 
+inline ThreadPool &ThreadPool::shared()
+{
+	static ThreadPool instance(std::thread::hardware_concurrency());
+	return instance;
+}
+
+inline void ThreadPool::setGlobalThreadLimit(const unsigned thread_limit)
+{
+	m_globalThreadLimit = thread_limit;
+}
+
+inline const unsigned ThreadPool::globalThreadCount()
+{
+	return m_globalThreadCount;
+}
+
 inline std::thread &ThreadPool::getThread(const unsigned index)
 {
 	return *m_threads.at(index);  // dereference from std::unique_ptr
@@ -128,6 +305,36 @@ inline const unsigned ThreadPool::totalThreadCount() const
 	return static_cast<unsigned>(m_threads.size());
 }
 
+inline const int ThreadPool::currentWorkerIndex() const noexcept
+{
+	const auto &worker = ThreadPool::currentWorker();
+	return worker.pool == this ? worker.index : -1;
+}
+
+inline ThreadPool *ThreadPool::currentPool() noexcept
+{
+	return ThreadPool::currentWorker().pool;
+}
+
+inline const bool ThreadPool::runPendingTask()
+{
+	const auto &worker = ThreadPool::currentWorker();
+	if(worker.pool != this)
+	{
+		return false;
+	}
+	impl::Task *task = nullptr;
+	for(unsigned level = 0u; level < static_cast<unsigned>(TaskPriority::Background); level++)
+	{
+		if(this->popLevel(task, *worker.node, level, true))
+		{
+			this->executeTask(task, worker.index, *worker.counters, false);
+			return true;
+		}
+	}
+	return false;
+}
+
 inline const unsigned ThreadPool::idleThreadCount() const
 {
 	return m_waitingThreadsCount;
@@ -138,6 +345,11 @@ inline const unsigned ThreadPool::pendingTasksCount() const
 	return m_pendingTasksCount;
 }
 
+inline std::pmr::memory_resource *ThreadPool::getMemoryResource() const noexcept
+{
+	return m_allocator.resource();
+}
+
 inline void ThreadPool::resize(const unsigned thread_count)
 {
 	if(!m_haltFlag && !m_finishedFlag)
@@ -145,14 +357,33 @@ inline void ThreadPool::resize(const unsigned thread_count)
 		const unsigned old_thread_count = static_cast<unsigned>(m_threads.size());
 		if(old_thread_count <= thread_count)  // if the new size is greater than the old one
 		{
+			//  reserve as many new threads as the global limit allows
+			const unsigned requested = thread_count - old_thread_count;
+			unsigned granted = requested;
+			unsigned global_count = m_globalThreadCount;
+			do
+			{
+				const unsigned limit = m_globalThreadLimit;
+				if(limit != 0u)
+				{
+					granted = (global_count >= limit) ? 0u : std::min(requested, limit - global_count);
+				}
+			} while(!m_globalThreadCount.compare_exchange_weak(global_count, global_count + granted));
+			const unsigned new_thread_count = old_thread_count + granted;
+
 			//  it's safe to resize as threads (and flags) are added, not removed
-			m_threads.resize(thread_count);
-			m_abortFlags.resize(thread_count);
+			m_threads.resize(new_thread_count);
+			m_abortFlags.resize(new_thread_count);
+			m_threadNodes.resize(new_thread_count);
+			m_workerCounters.resize(new_thread_count);
 
-			for(unsigned index = old_thread_count; index < thread_count; index++)
+			for(unsigned index = old_thread_count; index < new_thread_count; index++)
 			{
 				m_abortFlags[index] = std::make_shared<std::atomic<bool>>(false);
+				m_threadNodes[index] = std::make_shared<std::atomic<unsigned>>(TaskOptions::anyNode);
+				m_workerCounters[index] = std::make_shared<impl::WorkerCounters>();
 				this->setupThread(index);
+				this->applyAffinity(index);
 			}
 		}
 		else  // the new size is lower than the old one
@@ -173,6 +404,9 @@ inline void ThreadPool::resize(const unsigned thread_count)
 			//  flags are safe to remove as well, because threads hold copies of shared_ptr
 			m_threads.resize(thread_count);
 			m_abortFlags.resize(thread_count);
+			m_threadNodes.resize(thread_count);
+			m_workerCounters.resize(thread_count);
+			m_globalThreadCount -= (old_thread_count - thread_count);
 		}
 	}
 }
@@ -205,6 +439,7 @@ inline void ThreadPool::halt(const bool finish_tasks)
 		}
 		m_finishedFlag = true;  // all waiting threads should finish their tasks
 	}
+	this->stopTimers();
 	this->haltInfinite();
 	
 	{  // safety scope for std::unique_lock
@@ -223,18 +458,127 @@ inline void ThreadPool::halt(const bool finish_tasks)
 	// if there were no threads in the pool, but some functors in the queue, the functors are not
 	//   deleted by the threads, therefore they must be deleted here
 	this->clearQueue();
+	m_globalThreadCount -= static_cast<unsigned>(m_threads.size());
 	m_threads.clear();
 	m_abortFlags.clear();
+	m_threadNodes.clear();
+	m_workerCounters.clear();
+}
+
+inline void ThreadPool::setAffinity(const AffinityPolicy policy, const CpuTopology &topology)
+{
+	m_affinityPolicy = policy;
+	m_topology = topology;
+	for(unsigned index = 0u; index < this->totalThreadCount(); index++)
+	{
+		this->applyAffinity(index);
+	}
+}
+
+inline void ThreadPool::setBackgroundThreadLimit(const unsigned thread_limit) noexcept
+{
+	m_backgroundThreadLimit = thread_limit;
 }
 
-void ThreadPool::haltInfinite()
+inline const unsigned ThreadPool::backgroundThreadLimit() const noexcept
+{
+	return m_backgroundThreadLimit;
+}
+
+inline void ThreadPool::enableMetrics(const bool enabled) noexcept
+{
+	m_metricsEnabled = enabled;
+}
+
+inline PoolMetrics ThreadPool::metrics() const
+{
+	PoolMetrics result;
+	for(const auto &counters : m_workerCounters)
+	{
+		result.workers.push_back(counters->snapshot());
+	}
+	result.pendingTasks = m_pendingTasksCount;
+	result.idleThreads = m_waitingThreadsCount;
+	return result;
+}
+
+inline void ThreadPool::resetMetrics()
+{
+	for(auto &counters : m_workerCounters)
+	{
+		counters->reset();
+	}
+}
+
+inline void ThreadPool::setWaitPolicy(const WaitPolicy &policy) noexcept
+{
+	m_spinCount = policy.spinCount;
+	m_yieldCount = policy.yieldCount;
+}
+
+inline const WaitPolicy ThreadPool::getWaitPolicy() const noexcept
+{
+	return WaitPolicy{m_spinCount, m_yieldCount};
+}
+
+inline void ThreadPool::beginActiveFrame()
+{
+	if(m_activeFrames++ == 0u)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cond.notify_all();  // parked threads start spinning
+	}
+}
+
+inline void ThreadPool::endActiveFrame()
+{
+	unsigned frames = m_activeFrames;
+	while(frames > 0u && !m_activeFrames.compare_exchange_weak(frames, frames - 1u)) { }
+}
+
+inline const unsigned ThreadPool::nodeCount() const noexcept
+{
+	return static_cast<unsigned>(m_nodeQueues.size());
+}
+
+inline const unsigned ThreadPool::threadNode(const unsigned index) const
+{
+	return *m_threadNodes.at(index);
+}
+
+inline const unsigned ThreadPool::createLane()
+{
+	std::unique_lock<std::mutex> lock(m_laneMutex);
+	if(!m_freeLanes.empty())
+	{
+		const unsigned lane = m_freeLanes.back();
+		m_freeLanes.pop_back();
+		return lane;
+	}
+	return m_laneCount++;
+}
+
+inline void ThreadPool::releaseLane(const unsigned lane)
+{
+	std::unique_lock<std::mutex> lock(m_laneMutex);
+	if(lane != 0u && lane < m_laneCount)  // the default lane is never released
+	{
+		m_freeLanes.push_back(lane);
+	}
+}
+
+inline void ThreadPool::haltInfinite()
 {
 	m_infHaltFlag = true;
 }
 
-void ThreadPool::restart()
+inline void ThreadPool::restart()
 {
 	this->halt(true);  // wait for threads to finish all queued tasks
+	{  // safety scope for std::unique_lock
+		std::unique_lock<std::mutex> lock(m_timerMutex);
+		m_timerStop = false;  // the timer thread is started again by the next timer
+	}
 	m_finishedFlag = false;
 	m_haltFlag = false;
 	m_infHaltFlag = false;
@@ -250,21 +594,17 @@ inline auto ThreadPool::addTask(Functor &&func) -> std::future<decltype(func(0))
 {
 	if(!m_finishedFlag && !m_haltFlag)
 	{
-		auto package = std::make_shared<std::packaged_task<decltype(func(0))(const int)>>
-			(std::forward<Functor>(func));
+		auto package = std::allocate_shared<std::packaged_task<decltype(func(0))(const int)>>
+			(m_allocator, std::forward<Functor>(func));
 
-		auto task = new std::function<void(const int)>(
+		auto task = this->createTask(
 		[package](const int id)
 		{
 			(*package)(id);
 		});
 
-		m_pendingTasksCount++;
-		m_queue.push(task);
-
 		// notify a waiting thread that the task has been added
-		std::unique_lock<std::mutex> lock(m_mutex);
-		m_cond.notify_one();
+		this->enqueueTask(task);
 		return package->get_future();
 	}
 	else
@@ -278,21 +618,17 @@ inline auto ThreadPool::addTask(Functor &&func) -> std::future<decltype(func())>
 {
 	if(!m_finishedFlag && !m_haltFlag)
 	{
-		auto package = std::make_shared<std::packaged_task<decltype(func())()>>
-			(std::forward<Functor>(func));
+		auto package = std::allocate_shared<std::packaged_task<decltype(func())()>>
+			(m_allocator, std::forward<Functor>(func));
 
-		auto task = new std::function<void(const int)>(
+		auto task = this->createTask(
 		[package](const int id)
 		{
 			(*package)();
 		});
 
-		m_pendingTasksCount++;
-		m_queue.push(task);
-
 		// notify a waiting thread that the task has been added
-		std::unique_lock<std::mutex> lock(m_mutex);
-		m_cond.notify_one();
+		this->enqueueTask(task);
 		return package->get_future();
 	}
 	else
@@ -308,23 +644,20 @@ inline auto ThreadPool::addTask(Functor &&func, Args&& ...arguments) -> std::fut
 {
 	if(!m_finishedFlag && !m_haltFlag)
 	{
-		auto package = std::make_shared<std::packaged_task<decltype(func(0, arguments...))(const int)>>
+		auto package = std::allocate_shared<std::packaged_task<decltype(func(0, arguments...))(const int)>>
 		(
+			m_allocator,
 			std::bind(std::forward<Functor>(func), std::placeholders::_1, std::forward<Args>(arguments)...)
 		);
 
-		auto task = new std::function<void(const int)>(
+		auto task = this->createTask(
 		[package](const int id)
 		{
 			(*package)(id);
 		});
 
-		m_pendingTasksCount++;
-		m_queue.push(task);
-
 		// notify a waiting thread that the task just has been added
-		std::unique_lock<std::mutex> lock(m_mutex);
-		m_cond.notify_one();
+		this->enqueueTask(task);
 		return package->get_future();
 	}
 	else
@@ -338,23 +671,20 @@ inline auto ThreadPool::addTask(Functor &&func, Args&& ...arguments) -> std::fut
 {
 	if(!m_finishedFlag && !m_haltFlag)
 	{
-		auto package = std::make_shared<std::packaged_task<decltype(func(arguments...))()>>
+		auto package = std::allocate_shared<std::packaged_task<decltype(func(arguments...))()>>
 		(
+			m_allocator,
 			std::bind(std::forward<Functor>(func), std::forward<Args>(arguments)...)
 		);
 
-		auto task = new std::function<void(const int)>(
+		auto task = this->createTask(
 		[package](const int id)
 		{
 			(*package)();
 		});
 
-		m_pendingTasksCount++;
-		m_queue.push(task);
-
 		// notify a waiting thread that the task just has been added
-		std::unique_lock<std::mutex> lock(m_mutex);
-		m_cond.notify_one();
+		this->enqueueTask(task);
 		return package->get_future();
 	}
 	else
@@ -363,15 +693,114 @@ inline auto ThreadPool::addTask(Functor &&func, Args&& ...arguments) -> std::fut
 	}
 }
 
+template <typename Functor>
+inline auto ThreadPool::addTask(const TaskOptions &options, Functor &&func) -> std::future<decltype(func(0))>
+{
+	if(!m_finishedFlag && !m_haltFlag)
+	{
+		auto package = std::allocate_shared<std::packaged_task<decltype(func(0))(const int)>>
+			(m_allocator, std::forward<Functor>(func));
+
+		auto task = this->createTask(
+		[package](const int id)
+		{
+			(*package)(id);
+		});
+
+		// notify a waiting thread that the task has been added
+		this->enqueueTask(task, options);
+		return package->get_future();
+	}
+	else
+	{
+		return std::future<decltype(func(0))>();
+	}
+}
+
+template <typename Container>
+inline auto ThreadPool::addTasks(Container &&functions, const TaskOptions &options)
+	-> std::vector<std::future<decltype((*std::begin(functions))(0))>>
+{
+	using ResultT = decltype((*std::begin(functions))(0));
+	std::vector<std::future<ResultT>> results;
+	if(!m_finishedFlag && !m_haltFlag)
+	{
+		std::vector<impl::Task *> tasks;
+		for(auto &&func : functions)
+		{
+			auto package = std::allocate_shared<std::packaged_task<ResultT(const int)>>
+				(m_allocator, std::forward<decltype(func)>(func));
+
+			tasks.push_back(this->createTask(
+			[package](const int id)
+			{
+				(*package)(id);
+			}));
+			results.push_back(package->get_future());
+		}
+
+		// notify waiting threads that all tasks have been added
+		this->enqueueTasks(tasks, options);
+	}
+	return results;
+}
+
+template <typename Functor>
+inline ThreadPool::TimerID ThreadPool::addDelayedTask(
+	const std::chrono::steady_clock::duration delay,
+	Functor &&func,
+	const TaskOptions &options)
+{
+	auto timer = std::make_shared<impl::Timer>();
+	timer->func = std::forward<Functor>(func);
+	timer->options = options;
+	return this->scheduleTimer(std::move(timer), std::chrono::steady_clock::now() + delay);
+}
+
+template <typename Functor>
+inline ThreadPool::TimerID ThreadPool::addPeriodicTask(
+	const std::chrono::steady_clock::duration period,
+	Functor &&func,
+	const PeriodicMode mode,
+	const TaskOptions &options)
+{
+	auto timer = std::make_shared<impl::Timer>();
+	timer->func = std::forward<Functor>(func);
+	timer->period = std::max(period, std::chrono::steady_clock::duration(1));
+	timer->periodic = true;
+	timer->mode = mode;
+	timer->options = options;
+	return this->scheduleTimer(std::move(timer), std::chrono::steady_clock::now() + timer->period);
+}
+
+inline const bool ThreadPool::cancelTimer(const TimerID id)
+{
+	std::unique_lock<std::mutex> lock(m_timerMutex);
+	auto found = m_timers.find(id);
+	if(found == m_timers.end())
+	{
+		return false;
+	}
+	found->second->cancelled = true;  // a queued run is skipped
+	m_timers.erase(found);  // the deadline left in the heap is skipped by the timer thread
+	return true;
+}
+
+inline const unsigned ThreadPool::timerCount()
+{
+	std::unique_lock<std::mutex> lock(m_timerMutex);
+	return static_cast<unsigned>(m_timers.size());
+}
+
 template <typename Functor>
 inline auto ThreadPool::addInfiniteTask(Functor &&func) -> std::future<decltype(func(0))>
 {
 	if(!m_finishedFlag && !m_haltFlag)
 	{
-		auto package = std::make_shared<std::packaged_task<decltype(func(0))(const int)>>
-			(std::forward<Functor>(func));
+		auto package = std::allocate_shared<std::packaged_task<decltype(func(0))(const int)>>
+			(m_allocator, std::forward<Functor>(func));
 
-		auto task = new std::function<void(const int)>(
+		auto task = this->createTask(
 		[package, this](const int id)
 		{
 			while(!m_infHaltFlag && !m_haltFlag && !(*m_abortFlags.at(id)))
@@ -381,12 +810,10 @@ inline auto ThreadPool::addInfiniteTask(Functor &&func) -> std::future<decltype(
 			}
 		});
 
-		m_pendingTasksCount++;
-		m_queue.push(task);
+		task->infinite = true;  // waiting workers must not run it inline
 
 		// notify a waiting thread that the task has been added
-		std::unique_lock<std::mutex> lock(m_mutex);
-		m_cond.notify_one();
+		this->enqueueTask(task);
 		return package->get_future();
 	}
 	else
@@ -400,10 +827,10 @@ inline auto ThreadPool::addInfiniteTask(Functor &&func) -> std::future<decltype(
 {
 	if(!m_finishedFlag && !m_haltFlag)
 	{
-		auto package = std::make_shared<std::packaged_task<decltype(func())()>>
-			(std::forward<Functor>(func));
+		auto package = std::allocate_shared<std::packaged_task<decltype(func())()>>
+			(m_allocator, std::forward<Functor>(func));
 
-		auto task = new std::function<void(const int)>(
+		auto task = this->createTask(
 		[package, this](const int id)
 		{
 			while(!m_infHaltFlag && !m_haltFlag && !(*m_abortFlags.at(id)))
@@ -413,12 +840,10 @@ inline auto ThreadPool::addInfiniteTask(Functor &&func) -> std::future<decltype(
 			}
 		});
 
-		m_pendingTasksCount++;
-		m_queue.push(task);
+		task->infinite = true;  // waiting workers must not run it inline
 
 		// notify a waiting thread that the task has been added
-		std::unique_lock<std::mutex> lock(m_mutex);
-		m_cond.notify_one();
+		this->enqueueTask(task);
 		return package->get_future();
 	}
 	else
@@ -432,12 +857,13 @@ inline auto ThreadPool::addInfiniteTask(Functor &&func, Args&& ...arguments) ->
 {
 	if(!m_finishedFlag && !m_haltFlag)
 	{
-		auto package = std::make_shared<std::packaged_task<decltype(func(0, arguments...))(const int)>>
+		auto package = std::allocate_shared<std::packaged_task<decltype(func(0, arguments...))(const int)>>
 		(
+			m_allocator,
 			std::bind(std::forward<Functor>(func), std::placeholders::_1, std::forward<Args>(arguments)...)
 		);
 
-		auto task = new std::function<void(const int)>(
+		auto task = this->createTask(
 		[package, this](const int id)
 		{
 			while(!m_infHaltFlag && !m_haltFlag && !(*m_abortFlags.at(id)))
@@ -447,12 +873,10 @@ inline auto ThreadPool::addInfiniteTask(Functor &&func, Args&& ...arguments) ->
 			}
 		});
 
-		m_pendingTasksCount++;
-		m_queue.push(task);
+		task->infinite = true;  // waiting workers must not run it inline
 
 		// notify a waiting thread that the task just has been added
-		std::unique_lock<std::mutex> lock(m_mutex);
-		m_cond.notify_one();
+		this->enqueueTask(task);
 		return package->get_future();
 	}
 	else
@@ -466,12 +890,13 @@ inline auto ThreadPool::addInfiniteTask(Functor &&func, Args&& ...arguments) ->
 {
 	if(!m_finishedFlag && !m_haltFlag)
 	{
-		auto package = std::make_shared<std::packaged_task<decltype(func(arguments...))()>>
+		auto package = std::allocate_shared<std::packaged_task<decltype(func(arguments...))()>>
 		(
+			m_allocator,
 			std::bind(std::forward<Functor>(func), std::forward<Args>(arguments)...)
 		);
 
-		auto task = new std::function<void(const int)>(
+		auto task = this->createTask(
 		[package, this](const int id)
 		{
 			while(!m_infHaltFlag && !m_haltFlag && !(*m_abortFlags.at(id)))
@@ -481,12 +906,10 @@ inline auto ThreadPool::addInfiniteTask(Functor &&func, Args&& ...arguments) ->
 			}
 		});
 
-		m_pendingTasksCount++;
-		m_queue.push(task);
+		task->infinite = true;  // waiting workers must not run it inline
 
 		// notify a waiting thread that the task just has been added
-		std::unique_lock<std::mutex> lock(m_mutex);
-		m_cond.notify_one();
+		this->enqueueTask(task);
 		return package->get_future();
 	}
 	else
@@ -502,39 +925,56 @@ inline auto ThreadPool::addInfiniteTask(Functor &&func, Args&& ...arguments) ->
 inline void ThreadPool::setupThread(const int index)
 {
 	std::shared_ptr<std::atomic<bool>> flag(m_abortFlags[index]);  // a copy of shared ptr to the flag
-	auto task_wrapper = [this, index, flag]()
+	std::shared_ptr<std::atomic<unsigned>> node(m_threadNodes[index]);  // changed by setAffinity()
+	std::shared_ptr<impl::WorkerCounters> counters(m_workerCounters[index]);
+	auto task_wrapper = [this, index, flag, node, counters]()
 	{
+		using Clock = std::chrono::steady_clock;
 		std::atomic<bool> &flag_ref = *flag;
-		std::function<void(const int)> *task = nullptr;
-		bool any_available = m_queue.pop(task);  // true if popped any task, false otherwise
+		std::atomic<unsigned> &node_ref = *node;
+		impl::WorkerCounters &counters_ref = *counters;
+		ThreadPool::currentWorker() = impl::WorkerContext{this, index, &node_ref, &counters_ref};
+		impl::Task *task = nullptr;
+		bool background = false;  // true if the task holds a slot of the background thread limit
+		bool any_available = this->popTask(task, node_ref, background);  // true if popped any task, false otherwise
 		while(true)
 		{
 			while(any_available)  // if there's any task in the queue
 			{
-				m_pendingTasksCount--;
-				std::unique_ptr<std::function<void(const int)>> uq_task(task);  // the pointer here
-				  // holds the task object just for automatic deletion of it after it is executed
-				  // (at the end of this loop cycle)
-				(*task)(index);  //  execute task
+				this->executeTask(task, index, counters_ref, background);
 				if(flag_ref)
 				{
 					return;  // return even if the queue is not empty
 				}
 				else
 				{
-					any_available = m_queue.pop(task);  // assign next task
+					any_available = this->popTask(task, node_ref, background);  // assign next task
 				}
 			}
 			// the queue is empty (there are no tasks waiting for execution)
-			std::unique_lock<std::mutex> lock(m_mutex);
-			m_waitingThreadsCount++;
-			m_cond.wait(lock, [this, &task, &any_available, &flag_ref]()
+			const auto idle_start = Clock::now();
+			if(this->spinForTask(task, node_ref, background, flag_ref))
 			{
-				any_available = m_queue.pop(task);
-				return any_available || m_finishedFlag || flag_ref;
-			});
-			m_waitingThreadsCount--;
-			if(!any_available)
+				any_available = true;
+			}
+			else
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_waitingThreadsCount++;
+				m_cond.wait(lock, [this, &task, &any_available, &background, &flag_ref, &node_ref]()
+				{
+					any_available = this->popTask(task, node_ref, background);
+					return any_available || m_finishedFlag || flag_ref || m_activeFrames > 0u;
+				});
+				m_waitingThreadsCount--;
+			}
+			if(m_metricsEnabled)
+			{
+				counters_ref.idleNanoseconds.fetch_add(
+					std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - idle_start).count(),
+					std::memory_order_relaxed);
+			}
+			if(!any_available && (m_finishedFlag || flag_ref))
 			{
 				return;  // if queue is empty and (m_finishedFlag == true or *flag == true) then return
 			}
@@ -545,10 +985,440 @@ inline void ThreadPool::setupThread(const int index)
 
 inline void ThreadPool::clearQueue()
 {
-	std::function<void(const int id)> *task = nullptr;
+	impl::Task *task = nullptr;
 	while(m_queue.pop(task))
 	{
-		delete task;
+		this->destroyTask(task);
+	}
+	for(auto &queue : m_nodeQueues)
+	{
+		while(queue->pop(task))
+		{
+			this->destroyTask(task);
+		}
+	}
+}
+
+inline impl::WorkerContext &ThreadPool::currentWorker() noexcept
+{
+	static thread_local impl::WorkerContext worker;
+	return worker;
+}
+
+inline void ThreadPool::executeTask(
+	impl::Task *task,
+	const int index,
+	impl::WorkerCounters &counters,
+	const bool background)
+{
+	using Clock = std::chrono::steady_clock;
+	m_pendingTasksCount--;
+	if(task->expired())  // dropped without running, the packaged task breaks its promise
+	{
+		counters.tasksDropped.fetch_add(1u, std::memory_order_relaxed);
+	}
+	else if(m_metricsEnabled)
+	{
+		const auto start = Clock::now();
+		if(task->enqueueTime != Clock::time_point())
+		{
+			impl::WorkerCounters::record(counters.queueLatency, start - task->enqueueTime);
+		}
+		task->function(index);  //  execute task, packaged tasks never throw
+		const auto duration = Clock::now() - start;
+		impl::WorkerCounters::record(counters.taskDuration, duration);
+		counters.busyNanoseconds.fetch_add(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+			std::memory_order_relaxed);
+		counters.tasksExecuted.fetch_add(1u, std::memory_order_relaxed);
+		counters.steals.fetch_add(task->stolen ? 1u : 0u, std::memory_order_relaxed);
+	}
+	else
+	{
+		task->function(index);  //  execute task, packaged tasks never throw
+	}
+	this->destroyTask(task);
+	if(background)
+	{
+		m_backgroundThreadsCount--;
+	}
+}
+
+inline void ThreadPool::applyAffinity(const unsigned index)
+{
+	const auto &cpus = m_topology.cpus();
+	if(m_affinityPolicy == AffinityPolicy::None || cpus.empty())
+	{
+#if defined(__linux__)
+		if(*m_threadNodes[index] != TaskOptions::anyNode)  // the thread was pinned before
+		{
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			for(const auto &cpu : cpus)
+			{
+				CPU_SET(cpu.id, &set);
+			}
+			pthread_setaffinity_np(m_threads[index]->native_handle(), sizeof(cpu_set_t), &set);
+		}
+#endif
+		*m_threadNodes[index] = TaskOptions::anyNode;
+		return;
+	}
+
+	// cpus are sorted by node, so the compact placement just takes them in order
+	CpuTopology::Cpu cpu = cpus[index % cpus.size()];
+	if(m_affinityPolicy == AffinityPolicy::Scatter)
+	{
+		const unsigned node = index % m_topology.nodeCount();
+		const auto node_cpus = m_topology.cpusOfNode(node);
+		cpu = node_cpus[(index / m_topology.nodeCount()) % node_cpus.size()];
+	}
+
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu.id, &set);
+	if(pthread_setaffinity_np(m_threads[index]->native_handle(), sizeof(cpu_set_t), &set) != 0)
+	{
+		return;  // e.g. the CPU is not allowed for this process, the thread stays unpinned
+	}
+	*m_threadNodes[index] = cpu.node % this->nodeCount();
+#endif
+}
+
+inline const bool ThreadPool::spinForTask(
+	impl::Task *&task,
+	const unsigned node,
+	bool &background,
+	const std::atomic<bool> &abort_flag)
+{
+	// pending tasks are checked before popping, so that spinning threads don't contend for queue locks
+	const unsigned spin_count = m_spinCount;
+	const unsigned yield_count = m_yieldCount;
+	for(unsigned round = 0u; !m_finishedFlag && !abort_flag; round++)
+	{
+		if(m_pendingTasksCount > 0u && this->popTask(task, node, background))
+		{
+			return true;
+		}
+		if(round < spin_count)
+		{
+			impl::cpuRelax();
+		}
+		else if(round < spin_count + yield_count || m_activeFrames > 0u)
+		{
+			std::this_thread::yield();
+		}
+		else
+		{
+			break;
+		}
+	}
+	return false;
+}
+
+inline const bool ThreadPool::popTask(
+	impl::Task *&task,
+	const unsigned node,
+	bool &background)
+{
+	background = false;
+	for(unsigned level = 0u; level < impl::LaneQueue<impl::Task *>::levelCount; level++)
+	{
+		if(level != static_cast<unsigned>(TaskPriority::Background))
+		{
+			if(this->popLevel(task, node, level))
+			{
+				return true;
+			}
+			continue;
+		}
+
+		// take a slot of the background limit before popping, so that the limit is never exceeded
+		const unsigned limit = m_backgroundThreadLimit;
+		unsigned running = m_backgroundThreadsCount;
+		do
+		{
+			if(limit != 0u && running >= limit)
+			{
+				return false;
+			}
+		} while(!m_backgroundThreadsCount.compare_exchange_weak(running, running + 1u));
+
+		if(this->popLevel(task, node, level))
+		{
+			background = true;
+			return true;
+		}
+		m_backgroundThreadsCount--;
+	}
+	return false;
+}
+
+inline const bool ThreadPool::popLevel(
+	impl::Task *&task,
+	const unsigned node,
+	const unsigned level,
+	const bool finite_only)
+{
+	auto pop = [&task, level, finite_only](impl::LaneQueue<impl::Task *> &queue)
+	{
+		return finite_only
+			? queue.popIf(task, level, [](const impl::Task *queued) { return !queued->infinite; })
+			: queue.pop(task, level);
+	};
+
+	// the own node first, then tasks for everyone, then help other nodes
+	if(node < m_nodeQueues.size() && pop(*m_nodeQueues[node]))
+	{
+		return true;
+	}
+	if(pop(m_queue))
+	{
+		return true;
+	}
+	for(unsigned other = 0u; other < m_nodeQueues.size(); other++)
+	{
+		if(other != node && pop(*m_nodeQueues[other]))
+		{
+			task->stolen = (node != TaskOptions::anyNode);
+			return true;
+		}
+	}
+	return false;
+}
+
+inline ThreadPool::TimerID ThreadPool::scheduleTimer(
+	std::shared_ptr<impl::Timer> &&timer,
+	const std::chrono::steady_clock::time_point time)
+{
+	if(m_finishedFlag || m_haltFlag)
+	{
+		return TimerID{0};  // no timer has this identifier
+	}
+
+	std::unique_lock<std::mutex> lock(m_timerMutex);
+	if(m_timerStop)
+	{
+		return TimerID{0};
+	}
+	const TimerID id = m_nextTimerID++;
+	timer->id = id;
+	m_timers.emplace(id, std::move(timer));
+	m_timerHeap.emplace(time, id);
+	if(!m_timerThread.joinable())
+	{
+		m_timerThread = std::thread([this]() { this->timerLoop(); });
+	}
+	m_timerCond.notify_one();  // the new deadline may be the nearest one
+	return id;
+}
+
+inline void ThreadPool::runTimer(const std::shared_ptr<impl::Timer> &timer)
+{
+	auto task = this->createTask(
+	[this, timer](const int id)
+	{
+		if(timer->options.expired())  // the run is not dropped by the queue, so the timer is released here
+		{
+			this->cancelTimer(timer->id);
+		}
+		if(!timer->cancelled)
+		{
+			try
+			{
+				timer->func(id);
+			}
+			catch(...)  // there is no future to store the exception in
+			{
+				if(timer->periodic)
+				{
+					this->cancelTimer(timer->id);
+				}
+			}
+		}
+		timer->running = false;
+
+		if(timer->periodic && timer->mode == PeriodicMode::FixedDelay && !timer->cancelled)
+		{
+			std::unique_lock<std::mutex> lock(m_timerMutex);
+			if(!m_timerStop && m_timers.count(timer->id))
+			{
+				m_timerHeap.emplace(std::chrono::steady_clock::now() + timer->period, timer->id);
+				m_timerCond.notify_one();
+			}
+		}
+	});
+	// a dropped run would leave the timer running forever, expiration is checked by the run instead
+	TaskOptions options = timer->options;
+	options.token = CancellationToken();
+	options.deadline = std::chrono::steady_clock::time_point();
+	this->enqueueTask(task, options);
+}
+
+inline void ThreadPool::timerLoop()
+{
+	std::unique_lock<std::mutex> lock(m_timerMutex);
+	while(!m_timerStop)
+	{
+		if(m_timerHeap.empty())
+		{
+			m_timerCond.wait(lock);
+			continue;
+		}
+		const TimerEntry entry = m_timerHeap.top();
+		if(std::chrono::steady_clock::now() < entry.first)
+		{
+			m_timerCond.wait_until(lock, entry.first);  // woken up earlier if a nearer deadline is added
+			continue;
+		}
+		m_timerHeap.pop();
+
+		auto found = m_timers.find(entry.second);
+		if(found == m_timers.end())  // the timer has been cancelled
+		{
+			continue;
+		}
+		std::shared_ptr<impl::Timer> timer = found->second;
+		if(timer->options.expired())  // the token has been cancelled or the deadline has passed
+		{
+			timer->cancelled = true;
+			m_timers.erase(found);
+			continue;
+		}
+		if(!timer->periodic)
+		{
+			m_timers.erase(found);
+		}
+		else if(timer->mode == PeriodicMode::FixedRate)
+		{
+			// missed ticks are not caught up, the next one is the first in the future
+			auto next = entry.first + timer->period;
+			const auto now = std::chrono::steady_clock::now();
+			if(next <= now)
+			{
+				next += ((now - next) / timer->period + 1) * timer->period;
+			}
+			m_timerHeap.emplace(next, timer->id);
+		}
+
+		if(timer->running.exchange(true))  // the previous run has not finished yet
+		{
+			continue;
+		}
+		lock.unlock();
+		this->runTimer(timer);
+		lock.lock();
+	}
+}
+
+inline void ThreadPool::stopTimers()
+{
+	{  // safety scope for std::unique_lock
+		std::unique_lock<std::mutex> lock(m_timerMutex);
+		m_timerStop = true;
+		for(auto &timer : m_timers)
+		{
+			timer.second->cancelled = true;
+		}
+		m_timers.clear();
+		m_timerHeap = decltype(m_timerHeap)();
+		m_timerCond.notify_one();
+	}
+	if(m_timerThread.joinable())
+	{
+		m_timerThread.join();
+	}
+}
+
+template <typename Callable>
+inline impl::Task *ThreadPool::createTask(Callable &&callable)
+{
+	std::pmr::polymorphic_allocator<impl::Task> allocator(m_allocator);
+	auto task = allocator.allocate(1);
+	allocator.construct(task, std::forward<Callable>(callable));
+	if(m_metricsEnabled)
+	{
+		task->enqueueTime = std::chrono::steady_clock::now();  // tasks are enqueued right after creation
+	}
+	return task;
+}
+
+inline void ThreadPool::destroyTask(impl::Task *task)
+{
+	std::pmr::polymorphic_allocator<impl::Task> allocator(m_allocator);
+	allocator.destroy(task);
+	allocator.deallocate(task, 1);
+}
+
+inline void ThreadPool::enqueueTask(impl::Task *task, const TaskOptions &options)
+{
+	task->token = options.token;
+	task->deadline = options.deadline;
+	const unsigned level = static_cast<unsigned>(options.priority);
+	m_pendingTasksCount++;
+	if(options.node == TaskOptions::anyNode)
+	{
+		m_queue.push(task, options.lane, level);
+	}
+	else
+	{
+		m_nodeQueues[options.node % m_nodeQueues.size()]->push(task, options.lane, level);
+	}
+
+	this->notifyParked(1u);
+}
+
+inline void ThreadPool::enqueueTasks(
+	const std::vector<impl::Task *> &tasks,
+	const TaskOptions &options)
+{
+	if(tasks.empty())
+	{
+		return;
+	}
+
+	for(auto task : tasks)
+	{
+		task->token = options.token;
+		task->deadline = options.deadline;
+	}
+	const unsigned level = static_cast<unsigned>(options.priority);
+	m_pendingTasksCount += static_cast<unsigned>(tasks.size());
+	if(options.node == TaskOptions::anyNode)
+	{
+		m_queue.push(tasks.begin(), tasks.end(), options.lane, level);
+	}
+	else
+	{
+		m_nodeQueues[options.node % m_nodeQueues.size()]->push(tasks.begin(), tasks.end(), options.lane, level);
+	}
+
+	this->notifyParked(static_cast<unsigned>(tasks.size()));
+}
+
+inline void ThreadPool::notifyParked(const unsigned task_count)
+{
+	// spinning threads find the task themselves, only parked ones have to be notified
+	// the fence pairs with the increment of m_waitingThreadsCount done before a thread parks
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const unsigned parked = m_waitingThreadsCount;
+	if(parked == 0u)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if(task_count >= parked)
+	{
+		m_cond.notify_all();
+	}
+	else
+	{
+		for(unsigned index = 0u; index < task_count; index++)
+		{
+			m_cond.notify_one();
+		}
 	}
 }
 
@@ -0,0 +1,159 @@
+#include "../include/Topology.h"
+#include <fstream>
+
+namespace ecs
+{
+
+namespace
+{
+
+// reads the first line of a sysfs file, returns false if the file cannot be read
+bool readLine(const std::string &path, std::string &line)
+{
+	std::ifstream file(path);
+	return static_cast<bool>(std::getline(file, line));
+}
+
+unsigned readNumber(const std::string &path, const unsigned fallback)
+{
+	std::string line;
+	if(!readLine(path, line))
+	{
+		return fallback;
+	}
+	try
+	{
+		return static_cast<unsigned>(std::stoul(line));
+	}
+	catch(const std::exception &)
+	{
+		return fallback;
+	}
+}
+
+}  // namespace
+
+CpuTopology CpuTopology::detect()
+{
+	CpuTopology topology;
+	const std::string cpu_root = "/sys/devices/system/cpu/";
+	const std::string node_root = "/sys/devices/system/node/";
+
+	std::string line;
+	std::vector<unsigned> online;
+	if(readLine(cpu_root + "online", line))
+	{
+		online = CpuTopology::parseCpuList(line);
+	}
+	if(online.empty())  // no sysfs, every CPU is on the same node
+	{
+		online.resize(std::max(1u, std::thread::hardware_concurrency()));
+		std::iota(online.begin(), online.end(), 0u);
+	}
+
+	std::unordered_map<unsigned, unsigned> node_of_cpu;
+	if(readLine(node_root + "online", line))
+	{
+		for(auto node : CpuTopology::parseCpuList(line))
+		{
+			std::string cpu_list;
+			if(readLine(node_root + "node" + std::to_string(node) + "/cpulist", cpu_list))
+			{
+				for(auto cpu : CpuTopology::parseCpuList(cpu_list))
+				{
+					node_of_cpu[cpu] = node;
+				}
+			}
+		}
+	}
+
+	for(auto id : online)
+	{
+		const std::string topology_path = cpu_root + "cpu" + std::to_string(id) + "/topology/";
+		Cpu cpu;
+		cpu.id = id;
+		cpu.node = node_of_cpu.count(id) ? node_of_cpu[id] : 0u;
+		cpu.package = readNumber(topology_path + "physical_package_id", 0u);
+		cpu.core = readNumber(topology_path + "core_id", id);
+		topology.m_cpus.push_back(cpu);
+	}
+
+	// node indices of sysfs may have gaps (e.g. memory-only nodes), so they are renumbered
+	std::set<unsigned> nodes;
+	for(const auto &cpu : topology.m_cpus)
+	{
+		nodes.insert(cpu.node);
+	}
+	for(auto &cpu : topology.m_cpus)
+	{
+		cpu.node = static_cast<unsigned>(std::distance(nodes.begin(), nodes.find(cpu.node)));
+	}
+	topology.m_nodeCount = static_cast<unsigned>(std::max<std::size_t>(1u, nodes.size()));
+
+	std::sort(topology.m_cpus.begin(), topology.m_cpus.end(), [](const Cpu &lhs, const Cpu &rhs)
+	{
+		return std::tie(lhs.node, lhs.package, lhs.core, lhs.id)
+			< std::tie(rhs.node, rhs.package, rhs.core, rhs.id);
+	});
+	return topology;
+}
+
+const CpuTopology &CpuTopology::system()
+{
+	static const CpuTopology topology = CpuTopology::detect();
+	return topology;
+}
+
+const std::vector<CpuTopology::Cpu> &CpuTopology::cpus() const noexcept
+{
+	return m_cpus;
+}
+
+const unsigned CpuTopology::nodeCount() const noexcept
+{
+	return m_nodeCount;
+}
+
+std::vector<CpuTopology::Cpu> CpuTopology::cpusOfNode(const unsigned node) const
+{
+	std::vector<Cpu> result;
+	std::copy_if(m_cpus.begin(), m_cpus.end(), std::back_inserter(result), [node](const Cpu &cpu)
+	{
+		return cpu.node == node;
+	});
+	return result;
+}
+
+std::vector<unsigned> CpuTopology::parseCpuList(const std::string &list)
+{
+	std::vector<unsigned> result;
+	std::stringstream stream(list);
+	std::string item;
+	while(std::getline(stream, item, ','))
+	{
+		try
+		{
+			const auto dash = item.find('-');
+			if(dash == std::string::npos)
+			{
+				result.push_back(static_cast<unsigned>(std::stoul(item)));
+			}
+			else
+			{
+				const auto first = static_cast<unsigned>(std::stoul(item.substr(0u, dash)));
+				const auto last = static_cast<unsigned>(std::stoul(item.substr(dash + 1u)));
+				for(auto cpu = first; cpu <= last; cpu++)
+				{
+					result.push_back(cpu);
+				}
+			}
+		}
+		catch(const std::exception &)  // skip malformed items (e.g. an empty list)
+		{
+			continue;
+		}
+	}
+	return result;
+}
+
+}  // namespace ecs
@@ -0,0 +1,46 @@
+#include "Test.h"
+
+ECS_TEST(Async, systemRunsWhileCallerWorks)
+{
+	ecs::ThreadPool pool(3);
+	World world(2000u, pool);
+	populate(world, 1000u);
+
+	ecs::JobHandle job = world.applySystemAsync([](const Velocity &vel, Position &pos) { pos.x = vel.y; });
+	std::atomic<bool> continued{false};
+	ecs::JobHandle next = job.then([&continued]() { continued = true; });
+	next.wait();
+	ECS_CHECK(job.isDone());
+	ECS_CHECK(continued);
+	ECS_CHECK(world.countIf([](const Position &pos) { return pos.x == 2.f; }) == 1000u);
+}
+
+ECS_TEST(Async, cancelledRangesAreSkipped)
+{
+	ecs::ThreadPool pool(3);
+	World world(2000u, pool);
+	populate(world, 1000u);
+
+	ecs::CancellationSource source;
+	source.cancel();
+	std::atomic<int> calls{0};
+	ecs::JobHandle job = world.applySystemAsync([&calls](Position &) { calls++; }, source.token());
+	job.wait();
+	ECS_CHECK(job.isDone());
+	ECS_CHECK(calls == 0);
+}
+
+ECS_TEST(Async, haltedPoolRunsRangesInline)
+{
+	ecs::ThreadPool pool(2);
+	World world(2000u, pool);
+	populate(world, 1000u);
+	pool.halt();
+
+	std::atomic<int> calls{0};
+	ecs::JobHandle job = world.applySystemAsync([&calls](Position &pos) { pos.y = -1.f; calls++; });
+	ECS_CHECK(job.isDone());  // nothing is left for the halted pool
+	job.wait();
+	ECS_CHECK(calls == 1000);
+	ECS_CHECK(world.countIf([](const Position &pos) { return pos.y == -1.f; }) == 1000u);
+}
@@ -0,0 +1,58 @@
+#include "Test.h"
+
+ECS_TEST(Batch, resultsFollowTheContainer)
+{
+	ecs::ThreadPool pool(3);
+	std::vector<std::function<int(const int)>> tasks;
+	std::atomic<int> bad_ids{0};
+	for(int index = 0; index < 64; index++)
+	{
+		tasks.push_back([index, &bad_ids](const int id)
+		{
+			bad_ids += (id < 0 || id >= 3) ? 1 : 0;
+			return index * index;
+		});
+	}
+	auto results = pool.addTasks(tasks);  // copied functions, the container stays usable
+	ECS_CHECK(results.size() == 64u);
+	ECS_CHECK(tasks.size() == 64u);
+	bool ordered = true;
+	for(std::size_t index = 0u; index < results.size(); index++)
+	{
+		ordered = ordered && results[index].get() == static_cast<int>(index * index);
+	}
+	ECS_CHECK(ordered);
+	ECS_CHECK(bad_ids == 0);
+}
+
+ECS_TEST(Batch, exceptionsStayInTheirFutures)
+{
+	ecs::ThreadPool pool(2);
+	const unsigned lane = pool.createLane();
+	std::vector<std::function<void(const int)>> tasks;
+	tasks.push_back([](const int) { });
+	tasks.push_back([](const int) { throw std::runtime_error("task failed"); });
+	auto results = pool.addTasks(std::move(tasks), ecs::TaskOptions{lane});
+	ECS_CHECK(results.size() == 2u);
+	results[0].get();
+	bool thrown = false;
+	try
+	{
+		results[1].get();
+	}
+	catch(const std::runtime_error &)
+	{
+		thrown = true;
+	}
+	ECS_CHECK(thrown);
+	pool.releaseLane(lane);
+}
+
+ECS_TEST(Batch, haltedPoolAcceptsNothing)
+{
+	ecs::ThreadPool pool(2);
+	pool.halt();
+	std::vector<std::function<void(const int)>> tasks(4u, [](const int) { });
+	ECS_CHECK(pool.addTasks(tasks).empty());
+	ECS_CHECK(pool.pendingTasksCount() == 0u);
+}
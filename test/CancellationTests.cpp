@@ -0,0 +1,78 @@
+#include "Test.h"
+
+namespace
+{
+
+/**
+ * @brief Checks whether the future holds the broken promise of a dropped task.
+ */
+bool isDropped(std::future<void> &result)
+{
+	try
+	{
+		result.get();
+	}
+	catch(const std::future_error &error)
+	{
+		return error.code() == std::future_errc::broken_promise;
+	}
+	return false;
+}
+
+}  // namespace
+
+ECS_TEST(Cancellation, queuedTasksAreDropped)
+{
+	ecs::ThreadPool pool(1);
+	pool.enableMetrics(true);
+	std::atomic<bool> started{false};
+	std::atomic<bool> released{false};
+	pool.addTask([&started, &released]() { started = true; ecs::test::waitFor([&released]() { return released.load(); }); });
+	ECS_CHECK(ecs::test::waitFor([&started]() { return started.load(); }));
+
+	std::atomic<int> runs{0};
+	ecs::CancellationSource source;
+	ecs::TaskOptions cancelled;
+	cancelled.token = source.token();
+	ECS_CHECK(cancelled.token.canBeCancelled());
+	ecs::TaskOptions late;
+	late.deadline = std::chrono::steady_clock::now();  // passes before the worker is free
+	auto by_token = pool.addTask(cancelled, [&runs](const int) { runs++; });
+	auto by_deadline = pool.addTask(late, [&runs](const int) { runs++; });
+	auto kept = pool.addTask(ecs::TaskOptions{}, [&runs](const int) { runs++; });
+	source.cancel();
+	ECS_CHECK(source.isCancelled() && cancelled.token.isCancelled());
+	released = true;
+
+	ECS_CHECK(isDropped(by_token));
+	ECS_CHECK(isDropped(by_deadline));
+	kept.get();
+	ECS_CHECK(runs == 1);
+	ECS_CHECK(ecs::test::waitFor([&pool]() { return pool.metrics().total().tasksDropped == 2u; }));
+	ECS_CHECK(!ecs::CancellationToken().canBeCancelled());
+}
+
+ECS_TEST(Cancellation, expiredTimersAreReleased)
+{
+	ecs::ThreadPool pool(2);
+	std::atomic<int> runs{0};
+	ecs::TaskOptions options;
+	options.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+	pool.addPeriodicTask(std::chrono::milliseconds(1), [&runs](const int) { runs++; },
+		ecs::PeriodicMode::FixedRate, options);
+	pool.addPeriodicTask(std::chrono::milliseconds(1), [&runs](const int) { runs++; },
+		ecs::PeriodicMode::FixedDelay, options);
+	ECS_CHECK(ecs::test::waitFor([&pool]() { return pool.timerCount() == 0u; }));
+
+	ecs::CancellationSource source;
+	options = ecs::TaskOptions{};
+	options.token = source.token();
+	std::atomic<int> delayed{0};
+	pool.addDelayedTask(std::chrono::milliseconds(5), [&delayed](const int) { delayed++; }, options);
+	source.cancel();  // released by the timer thread at its deadline, without running
+	ECS_CHECK(ecs::test::waitFor([&pool]() { return pool.timerCount() == 0u && pool.pendingTasksCount() == 0u; }));
+	std::atomic<bool> sentinel{false};
+	pool.addDelayedTask(std::chrono::milliseconds(5), [&sentinel](const int) { sentinel = true; });
+	ECS_CHECK(ecs::test::waitFor([&sentinel]() { return sentinel.load(); }));
+	ECS_CHECK(delayed == 0);
+}
@@ -0,0 +1,91 @@
+#include "Test.h"
+
+namespace
+{
+
+struct Hit
+{
+	ecs::uint64 entity;
+	float value;
+};
+
+/**
+ * @brief Runs one frame of a deterministic world and describes its results.
+ * @return The reduced sum and the ids of emitted events, identical for every thread count.
+ */
+std::pair<float, std::vector<ecs::uint64>> deterministicFrame(const unsigned threads)
+{
+	ecs::ThreadPool pool(threads);
+	World world(20000u, pool);
+	world.setDeterministic(true, 257u);
+	populate(world, 12000u);
+	ecs::EventChannel<Hit> hits(pool);
+	hits.setOrdered(true);
+	world.registerSystem([&hits](ecs::Interface &itf, Position &pos)
+	{
+		pos.y += pos.x * 0.001f;
+		if(itf.id() % 7u == 0u)
+		{
+			hits.emit(Hit{itf.id(), pos.y});
+		}
+	});
+	world.registerSystem([&hits](ecs::Interface &itf, const Energy &energy)
+	{
+		hits.emit(Hit{itf.id(), static_cast<float>(energy.value)});
+	});
+	world.runSystems();
+	hits.swap();
+
+	std::vector<ecs::uint64> order;
+	for(const auto &hit : hits.read())
+	{
+		order.push_back(hit.entity);
+	}
+	return {world.reduce(0.f, [](const Position &pos) { return pos.x * 0.37f + pos.y; }, std::plus<>()), order};
+}
+
+}  // namespace
+
+ECS_TEST(Deterministic, resultsIgnoreTheThreadCount)
+{
+	const auto expected = deterministicFrame(0u);
+	ECS_CHECK(!expected.second.empty());
+	for(const unsigned threads : {1u, 2u, 5u})
+	{
+		const auto result = deterministicFrame(threads);
+		ECS_CHECK(result.first == expected.first);    // bitwise identical float sums
+		ECS_CHECK(result.second == expected.second);  // events merged in the same order
+	}
+}
+
+ECS_TEST(Deterministic, deletionKeepsTheOrder)
+{
+	ecs::ThreadPool pool(2);
+	World world(1000u, pool);
+	bool thrown = false;
+	try
+	{
+		world.setDeterministic(true, 0u);
+	}
+	catch(const std::invalid_argument &)
+	{
+		thrown = true;
+	}
+	ECS_CHECK(thrown);
+	ECS_CHECK(!world.isDeterministic());
+
+	world.setDeterministic(true);
+	ECS_CHECK(world.isDeterministic());
+	const ecs::uint64 first = populate(world, 100u);
+	world.deleteEntity(first + 10u);
+	world.deleteEntity(first);
+	const auto &entities = world.getEntityBuffer();
+	const auto &positions = world.getComponentBucket<Position>();
+	ECS_CHECK(entities.size() == 98u);
+	bool ordered = true;
+	for(std::size_t index = 1u; index < entities.size(); index++)
+	{
+		ordered = ordered && entities[index - 1u] < entities[index] && positions[index].eID() == entities[index];
+	}
+	ECS_CHECK(ordered);
+}
@@ -0,0 +1,83 @@
+#include "Test.h"
+
+namespace
+{
+
+struct Hit
+{
+	ecs::uint64 entity;
+	float value;
+};
+
+}  // namespace
+
+ECS_TEST(Events, swapPublishesEmittedEvents)
+{
+	ecs::ThreadPool pool(3);
+	World world(10000u, pool);
+	populate(world, 6000u);
+	ecs::EventChannel<Hit> hits(pool);
+	world.registerSystem([&hits](ecs::Interface &itf, const Energy &energy)
+	{
+		hits.emit(Hit{itf.id(), static_cast<float>(energy.value)});
+	});
+
+	world.runSystems();
+	hits.emit(Hit{0u, -1.f});  // the calling thread has its own buffer too
+	ECS_CHECK(hits.size() == 0u);
+	hits.swap();
+	ECS_CHECK(hits.size() == 2001u);
+	std::unordered_set<ecs::uint64> unique;
+	for(const auto &hit : hits.read())
+	{
+		unique.insert(hit.entity);
+	}
+	ECS_CHECK(unique.size() == 2000u);
+	ECS_CHECK(hits.read()[2000u].value == -1.f);  // events of other threads come last
+
+	hits.swap();  // nothing emitted in the meantime
+	ECS_CHECK(hits.size() == 0u);
+	world.runSystems();
+	hits.clear();
+	hits.swap();
+	ECS_CHECK(hits.read().size() == 0u);
+}
+
+ECS_TEST(Events, threadsOutsideThePoolShareOneBuffer)
+{
+	ecs::ThreadPool pool(2);
+	ecs::EventChannel<Hit> hits(pool);
+	std::vector<std::thread> threads;
+	for(ecs::uint64 thread = 0u; thread < 4u; thread++)
+	{
+		threads.emplace_back([&hits, thread]()
+		{
+			for(ecs::uint64 index = 0u; index < 1000u; index++)
+			{
+				hits.emit(Hit{thread * 1000u + index, 0.f});
+			}
+		});
+	}
+	std::vector<std::future<void>> results;
+	for(ecs::uint64 index = 0u; index < 100u; index++)
+	{
+		results.push_back(pool.addTask([&hits, index]() { hits.emit(Hit{10000u + index, 1.f}); }));
+	}
+	for(auto &thread : threads)
+	{
+		thread.join();
+	}
+	for(auto &result : results)
+	{
+		result.get();
+	}
+	hits.swap();
+	ECS_CHECK(hits.size() == 4100u);
+	std::unordered_set<ecs::uint64> unique;
+	for(const auto &hit : hits.read())
+	{
+		unique.insert(hit.entity);
+	}
+	ECS_CHECK(unique.size() == 4100u);
+	ECS_CHECK(hits.read()[0].value == 1.f);  // workers first
+}
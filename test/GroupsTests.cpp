@@ -0,0 +1,110 @@
+#include "Test.h"
+
+namespace
+{
+
+/**
+ * @brief Checks whether members of the Position and Velocity group are packed at the front.
+ * @return The number of members, 0 if owned buckets do not match.
+ */
+std::size_t packedMembers(World &world)
+{
+	std::size_t members = 0u;
+	world.applyGroup([&members](const Position &, const Velocity &) { members++; });
+	const auto &positions = world.getComponentBucket<Position>();
+	const auto &velocities = world.getComponentBucket<Velocity>();
+	for(std::size_t index = 0u; index < members; index++)
+	{
+		if(positions[index].eID() != velocities[index].eID())
+		{
+			return 0u;
+		}
+	}
+	std::unordered_set<ecs::uint64> rest;
+	for(std::size_t index = members; index < positions.size(); index++)
+	{
+		rest.insert(positions[index].eID());
+	}
+	for(std::size_t index = members; index < velocities.size(); index++)
+	{
+		if(rest.count(velocities[index].eID()) != 0u)
+		{
+			return 0u;
+		}
+	}
+	return members;
+}
+
+}  // namespace
+
+ECS_TEST(Groups, membersStayPacked)
+{
+	ecs::ThreadPool pool(2);
+	World world(5000u, pool);
+	ecs::Prefab<Pool> still;
+	still.set(Position{0.f, 0.f});
+	ecs::Prefab<Pool> moving;
+	moving.set(Position{0.f, 0.f}).set(Velocity{1.f, 0.f});
+	ecs::Prefab<Pool> ghost;
+	ghost.set(Velocity{1.f, 0.f});
+	world.spawn(still, 30u);
+	const ecs::uint64 first = world.spawn(moving, 50u);
+	world.spawn(ghost, 20u);
+
+	world.group<Position, Velocity>();
+	ECS_CHECK(packedMembers(world) == 50u);
+
+	world.spawn(moving, 100u);  // a large batch rebuilds the group
+	world.spawn(still, 10u);
+	ECS_CHECK(packedMembers(world) == 150u);
+
+	for(ecs::uint64 id = first; id < first + 50u; id += 3u)
+	{
+		world.deleteEntity(id);
+	}
+	ECS_CHECK(packedMembers(world) == 150u - 17u);
+
+	world.sort<Velocity>([](const Velocity &lhs, const Velocity &rhs) { return lhs.x > rhs.x; });
+	ECS_CHECK(packedMembers(world) == 133u);
+
+	std::size_t members = 0u;
+	world.applyGroup([&members](Position &pos, const Velocity &vel) { pos.x += vel.x; members++; });
+	ECS_CHECK(members == 133u);
+	ECS_CHECK(world.countIf([](const Position &pos) { return pos.x == 1.f; }) == members);
+
+	bool thrown = false;
+	try
+	{
+		world.group<Velocity, Energy>();
+	}
+	catch(const std::logic_error &)
+	{
+		thrown = true;
+	}
+	ECS_CHECK(thrown);
+}
+
+ECS_TEST(Groups, smallBatchesJoinOneByOne)
+{
+	ecs::ThreadPool pool(2);
+	World world(30000u, pool);
+	world.group<Position, Velocity>();
+	ecs::Prefab<Pool> moving;
+	moving.set(Position{0.f, 0.f}).set(Velocity{1.f, 0.f});
+	ecs::Prefab<Pool> still;
+	still.set(Position{0.f, 0.f});
+
+	// entities spawned one at a time must not rebuild the whole group every time
+	for(ecs::uint64 index = 0u; index < 20000u; index++)
+	{
+		world.spawn(index % 4u == 0u ? still : moving, 1u);
+	}
+	ECS_CHECK(packedMembers(world) == 15000u);
+
+	world.spawn(moving, 7u);
+	world.spawn(still, 3u);
+	ECS_CHECK(packedMembers(world) == 15007u);
+
+	world.addEntities(5u, 3u, 0u);  // Position and Velocity with default values
+	ECS_CHECK(packedMembers(world) == 15012u);
+}
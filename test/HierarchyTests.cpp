@@ -0,0 +1,99 @@
+#include "Test.h"
+
+ECS_TEST(Hierarchy, propagateSplitsBelowRoots)
+{
+	for(const unsigned threads : {0u, 3u})
+	{
+		ecs::ThreadPool pool(threads);
+		World world(10000u, pool);
+		ecs::Prefab<Pool> node;
+		node.set(Transform{1.0, 0.0});
+		ecs::Prefab<Pool> bare;
+		bare.set(Position{0.f, 0.f});
+		const ecs::uint64 count = 6000u;
+		const ecs::uint64 first = world.spawn(node, 1u);
+		for(ecs::uint64 index = 1u; index < count; index++)
+		{
+			world.spawn(index % 97u == 50u ? bare : node, 1u);
+		}
+
+		// one root: a chain on top, then a random tree, so the walk has to split below the root
+		ecs::Hierarchy &tree = world.getHierarchy();
+		std::vector<ecs::uint64> parents(count, ecs::Hierarchy::none);
+		for(ecs::uint64 index = 1u; index < count; index++)
+		{
+			parents[index] = index < 50u ? index - 1u : ((index * 2654435761u) >> 8u) % index;
+			tree.setParent(first + index, first + parents[index]);
+		}
+		world.getComponentBucket<Transform>()[0]().world = 1.0;
+
+		for(int frame = 0; frame < 2; frame++)
+		{
+			std::vector<double> expected(count, -1.0);
+			for(const auto &tr : world.getComponentBucket<Transform>())
+			{
+				expected[tr.eID() - first] = tr().world;
+			}
+			for(const auto &entry : tree.order())
+			{
+				const ecs::uint64 index = entry.entity - first;
+				if(entry.parent != ecs::Hierarchy::none && expected[index] >= 0.0 && expected[parents[index]] >= 0.0)
+				{
+					expected[index] = expected[parents[index]] * 0.5 + 1.0;
+				}
+			}
+			world.propagate<Transform>([](Transform &child, const Transform &parent)
+			{
+				child.world = parent.world * 0.5 + child.local;
+			});
+			bool propagated = true;
+			for(const auto &tr : world.getComponentBucket<Transform>())
+			{
+				propagated = propagated && tr().world == expected[tr.eID() - first];
+			}
+			ECS_CHECK(propagated);
+			tree.setParent(first + 3000u, first);  // the order is rebuilt for the next frame
+			parents[3000u] = 0u;
+		}
+
+		const auto &order = tree.order();
+		bool nested = true;
+		for(std::size_t index = 0u; index < order.size(); index++)
+		{
+			nested = nested && (order[index].parentIndex == ecs::Hierarchy::none || order[index].parentIndex < index);
+			nested = nested && order[index].subtreeEnd > index && order[index].subtreeEnd <= order.size();
+		}
+		ECS_CHECK(nested);
+		ECS_CHECK(order.front().subtreeEnd == order.size());
+	}
+}
+
+ECS_TEST(Hierarchy, propagateKeepsTheBucketOrder)
+{
+	ecs::ThreadPool pool(2);
+	World world(1000u, pool);
+	ecs::Prefab<Pool> node;
+	node.set(Transform{1.0, 0.0}).set(Energy{0.0});
+	const ecs::uint64 first = world.spawn(node, 100u);
+	for(ecs::uint64 index = 1u; index < 100u; index++)  // a chain walked in the order of the bucket
+	{
+		world.getHierarchy().setParent(first + index, first + index - 1u);
+	}
+	for(auto &energy : world.getComponentBucket<Energy>())
+	{
+		energy().value = -static_cast<double>(energy.eID());
+	}
+	world.sort<Energy>([](const Energy &lhs, const Energy &rhs) { return lhs.value < rhs.value; });  // reversed
+
+	world.propagate<Transform>([](Transform &child, const Transform &parent) { child.world = parent.world + child.local; });
+	const auto &entities = world.getEntityBuffer();
+	const auto &transforms = world.getComponentBucket<Transform>();
+	bool lockstep = true;
+	for(std::size_t index = 0u; index < transforms.size(); index++)
+	{
+		lockstep = lockstep && transforms[index].eID() == entities[index];
+	}
+	ECS_CHECK(lockstep);  // systems may still walk buckets by entity indices
+	ECS_CHECK(world.getComponent<Transform>(first + 99u).world == 99.0);
+	ECS_CHECK(world.getComponent<Transform>(first).world == 0.0);
+}
@@ -0,0 +1,55 @@
+#include "Test.h"
+
+ECS_TEST(Insert, bulkInsertAndStridedView)
+{
+	ecs::ThreadPool pool(2);
+	World world(1000u, pool);
+	const ecs::uint64 first = world.addEntities(100u, 0u, 0u);
+	std::vector<Position> decoded(100u);
+	for(std::size_t index = 0u; index < decoded.size(); index++)
+	{
+		decoded[index] = Position{float(index), 1.f};
+	}
+
+	world.insertComponents<Position>(first, decoded);
+	ECS_CHECK(decoded.size() == 100u);  // the caller keeps its array
+	ECS_CHECK(world.getComponentBucket<Position>().size() == 100u);
+	ECS_CHECK(world.getComponent<Position>(first + 37u).x == 37.f);
+	ECS_CHECK(world.countIf([](const Position &pos) { return pos.y == 1.f; }) == 100u);
+
+	auto view = world.viewComponents<Position>();
+	ECS_CHECK(view.size() == 100u);
+	ECS_CHECK(view[37].x == 37.f);
+	ECS_CHECK(view.stride() == sizeof(ecs::ComponentWrapper<Position>));
+	ECS_CHECK(!view.contiguous());  // interleaved with entity ids
+	view[5].y = 2.f;
+	ECS_CHECK(world.getComponent<Position>(first + 5u).y == 2.f);
+	ECS_CHECK(world.viewComponents<Energy>().empty());
+}
+
+ECS_TEST(Insert, rejectedInsertLeavesEntitiesUntouched)
+{
+	ecs::ThreadPool pool(2);
+	World world(1000u, pool);
+	const ecs::uint64 first = world.addEntities(10u, 0u, 0u);
+	std::vector<Energy> energy(10u, Energy{1.0});
+	world.insertComponents<Energy>(first, energy);
+
+	bool thrown = false;
+	try
+	{
+		world.insertComponents<Energy>(first + 5u, energy);  // overlaps and runs past the end
+	}
+	catch(const std::invalid_argument &)
+	{
+		thrown = true;
+	}
+	ECS_CHECK(thrown);
+	ECS_CHECK(world.getComponentBucket<Energy>().size() == 10u);
+	ECS_CHECK(world.countIf([](const Energy &) { return true; }) == 10u);
+
+	std::vector<Velocity> velocity(3u, Velocity{1.f, 1.f});
+	world.insertComponents<Velocity>(first + 2u, velocity);
+	ECS_CHECK(world.countIf([](const Velocity &) { return true; }) == 3u);
+	ECS_CHECK(world.viewComponents<Velocity>()[0].x == 1.f);
+}
@@ -0,0 +1,93 @@
+#include "Test.h"
+
+ECS_TEST(JobGraph, dependenciesFinishFirst)
+{
+	ecs::ThreadPool pool(3);
+	ecs::JobGraph graph;
+	std::atomic<int> step{0};
+	std::atomic<bool> ordered{true};
+	const auto input = graph.addJob([&step]() { step = 1; });
+	const auto first = graph.addJob([&step, &ordered]() { ordered = ordered && step >= 1; }, {input});
+	const auto second = graph.addJob([&step, &ordered]() { ordered = ordered && step >= 1; }, {input});
+	const auto join = graph.addJob({}, {first, second});  // only joins its dependencies
+	graph.addJob([&step, &ordered]() { ordered = ordered && step == 1; step = 2; }, {join});
+	ECS_CHECK(graph.jobCount() == 5u);
+
+	for(int frame = 0; frame < 20; frame++)  // the graph is submitted again every frame
+	{
+		step = 0;
+		graph.submit(pool).wait();
+		ECS_CHECK(step == 2);
+	}
+	ECS_CHECK(ordered);
+
+	ecs::ThreadPool inline_pool(0);  // the caller executes jobs
+	step = 0;
+	ECS_CHECK(graph.submit(inline_pool).isDone());
+	ECS_CHECK(step == 2);
+}
+
+ECS_TEST(JobGraph, cyclesAndWrongIndicesThrow)
+{
+	ecs::ThreadPool pool(2);
+	ecs::JobGraph graph;
+	const auto first = graph.addJob([]() { });
+	const auto second = graph.addJob([]() { }, {first});
+	bool thrown = false;
+	try
+	{
+		graph.addDependency(second, 7u);
+	}
+	catch(const std::invalid_argument &)
+	{
+		thrown = true;
+	}
+	ECS_CHECK(thrown);
+
+	graph.addDependency(first, second);
+	thrown = false;
+	try
+	{
+		graph.submit(pool);
+	}
+	catch(const std::logic_error &)
+	{
+		thrown = true;
+	}
+	ECS_CHECK(thrown);
+
+	graph.clear();
+	ECS_CHECK(graph.jobCount() == 0u);
+	ECS_CHECK(graph.submit(pool).isDone());
+}
+
+ECS_TEST(JobGraph, exceptionsAndCancellation)
+{
+	ecs::ThreadPool pool(2);
+	ecs::JobGraph graph;
+	std::atomic<int> runs{0};
+	const auto failing = graph.addJob([]() { throw std::runtime_error("job failed"); });
+	graph.addJob([&runs]() { runs++; }, {failing});
+	bool thrown = false;
+	try
+	{
+		graph.submit(pool).wait();
+	}
+	catch(const std::runtime_error &)
+	{
+		thrown = true;
+	}
+	ECS_CHECK(thrown);
+	ECS_CHECK(runs == 0);
+
+	graph.clear();
+	graph.addJob([&runs]() { runs++; });
+	ecs::CancellationSource source;
+	source.cancel();
+	ecs::TaskOptions options;
+	options.token = source.token();
+	ecs::JobHandle job = graph.submit(pool, options);
+	job.wait();
+	ECS_CHECK(job.isDone());
+	ECS_CHECK(runs == 0);
+}
@@ -0,0 +1,41 @@
+#include "Test.h"
+
+namespace ecs::test
+{
+
+std::vector<TestCase> &registry()
+{
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+Registration::Registration(const char *suite, const char *name, const TestFunction function)
+{
+	registry().push_back(TestCase{suite, name, function});
+}
+
+}  // namespace ecs::test
+
+int main(int argc, char **argv)
+{
+	int failed_tests = 0;
+	bool found = false;
+	for(const auto &test : ecs::test::registry())
+	{
+		if(argc >= 2 && test.suite != argv[1])
+		{
+			continue;
+		}
+		found = true;
+		int failures = 0;
+		test.function(failures);
+		std::cout << (failures == 0 ? "[PASSED] " : "[FAILED] ") << test.suite << "." << test.name << std::endl;
+		failed_tests += failures == 0 ? 0 : 1;
+	}
+	if(!found)
+	{
+		std::cerr << "Unknown suite: " << argv[1] << std::endl;
+		return 1;
+	}
+	return failed_tests == 0 ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include "Test.h"
+
+namespace
+{
+
+/**
+ * @brief The thread-safe resource counting bytes it hands out.
+ */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	std::atomic<std::size_t> allocated{0u};  /**< Bytes currently allocated. */
+	std::atomic<std::size_t> total{0u};      /**< Bytes allocated since the construction. */
+
+private:
+	void *do_allocate(const std::size_t bytes, const std::size_t alignment) override
+	{
+		allocated += bytes;
+		total += bytes;
+		return m_upstream.allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void *pointer, const std::size_t bytes, const std::size_t alignment) override
+	{
+		allocated -= bytes;
+		m_upstream.deallocate(pointer, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+	{
+		return this == &other;
+	}
+
+	std::pmr::synchronized_pool_resource m_upstream;
+};
+
+}  // namespace
+
+ECS_TEST(Memory, worldStorageUsesTheResource)
+{
+	CountingResource resource;
+	{
+		ecs::ThreadPool pool(2);
+		World world(1000u, pool, &resource);
+		ECS_CHECK(world.getMemoryResource() == &resource);
+		ECS_CHECK(resource.allocated > 0u);  // the max entity count is reserved up front
+
+		const std::size_t reserved = resource.total;
+		populate(world, 1000u);
+		ECS_CHECK(world.getComponentBucket<Position>().get_allocator().resource() == &resource);
+		ECS_CHECK(world.getComponentBucket<Velocity>().size() == 1000u);
+		ECS_CHECK(resource.total == reserved);  // entities fitting in the max cap do not reallocate
+	}
+	ECS_CHECK(resource.allocated == 0u);
+}
+
+ECS_TEST(Memory, poolTasksUseTheResource)
+{
+	CountingResource resource;
+	{
+		ecs::ThreadPool pool(2, &resource);
+		ECS_CHECK(pool.getMemoryResource() == &resource);
+		std::vector<std::future<int>> results;
+		for(int index = 0; index < 100; index++)
+		{
+			results.push_back(pool.addTask([index]() { return index * 2; }));
+		}
+		int sum = 0;
+		for(auto &result : results)
+		{
+			sum += result.get();
+		}
+		ECS_CHECK(sum == 9900);
+		ECS_CHECK(resource.total > 0u);
+	}
+	ECS_CHECK(resource.allocated == 0u);
+}
@@ -0,0 +1,75 @@
+#include "Test.h"
+
+ECS_TEST(Metrics, histogramBuckets)
+{
+	using ecs::LatencyHistogram;
+	bool contiguous = true;
+	for(std::size_t bucket = 0u; bucket + 1u < LatencyHistogram::bucketCount; bucket++)
+	{
+		const ecs::uint64 bound = LatencyHistogram::upperBound(bucket);
+		contiguous = contiguous && LatencyHistogram::bucketOf(bound) == bucket
+			&& LatencyHistogram::bucketOf(bound + 1u) == bucket + 1u;
+	}
+	ECS_CHECK(contiguous);
+	ECS_CHECK(LatencyHistogram::upperBound(LatencyHistogram::bucketCount - 1u) == ~ecs::uint64{0});
+	ECS_CHECK(LatencyHistogram::bucketOf(~ecs::uint64{0}) == LatencyHistogram::bucketCount - 1u);
+}
+
+ECS_TEST(Metrics, histogramPercentiles)
+{
+	ecs::LatencyHistogram histogram;
+	ECS_CHECK(histogram.percentile(0.5).count() == 0);
+	for(int index = 0; index < 90; index++)
+	{
+		histogram.record(std::chrono::nanoseconds(10));
+	}
+	for(int index = 0; index < 10; index++)
+	{
+		histogram.record(std::chrono::microseconds(1));
+	}
+	histogram.record(std::chrono::nanoseconds(-5));  // clamped to zero
+	ECS_CHECK(histogram.count() == 101u);
+	ECS_CHECK(histogram.bucketCountAt(0u) == 1u);
+	// percentiles report the upper bound of the bucket, at most 25% above the value
+	ECS_CHECK(histogram.percentile(0.5).count() >= 10 && histogram.percentile(0.5).count() < 13);
+	ECS_CHECK(histogram.percentile(0.99).count() >= 1000 && histogram.percentile(0.99).count() < 1250);
+	ECS_CHECK(histogram.percentile(0.0).count() == 0);
+
+	ecs::LatencyHistogram other;
+	other.record(std::chrono::microseconds(1));
+	histogram.merge(other);
+	ECS_CHECK(histogram.count() == 102u);
+	ECS_CHECK(histogram.bucketCountAt(ecs::LatencyHistogram::bucketOf(1000u)) == 11u);
+}
+
+ECS_TEST(Metrics, poolSnapshots)
+{
+	ecs::ThreadPool pool(2);
+	pool.addTask([]() { }).get();
+	ECS_CHECK(pool.metrics().total().tasksExecuted == 0u);  // disabled by default
+
+	pool.enableMetrics(true);
+	std::vector<std::future<void>> results;
+	for(int index = 0; index < 50; index++)
+	{
+		results.push_back(pool.addTask([]() { std::this_thread::sleep_for(std::chrono::microseconds(50)); }));
+	}
+	for(auto &result : results)
+	{
+		result.wait();
+	}
+	// counters are updated after the future is ready
+	ECS_CHECK(ecs::test::waitFor([&pool]() { return pool.metrics().total().tasksExecuted == 50u; }));
+	const auto snapshot = pool.metrics();
+	ECS_CHECK(snapshot.workers.size() == 2u);
+	const auto total = snapshot.total();
+	ECS_CHECK(total.taskDuration.count() == 50u);
+	ECS_CHECK(total.queueLatency.count() == 50u);
+	ECS_CHECK(total.taskDuration.percentile(0.5) >= std::chrono::microseconds(50));
+	ECS_CHECK(total.busyTime >= std::chrono::microseconds(50 * 50));
+	ECS_CHECK(total.utilization() >= 0.0 && total.utilization() <= 1.0);
+
+	pool.resetMetrics();
+	ECS_CHECK(pool.metrics().total().tasksExecuted == 0u);
+	ECS_CHECK(pool.metrics().total().taskDuration.count() == 0u);
+}
@@ -0,0 +1,63 @@
+#include "Test.h"
+
+ECS_TEST(Observers, flushDeliversNetChanges)
+{
+	ecs::ThreadPool pool(2);
+	World world(1000u, pool);
+	std::vector<ecs::uint64> added, removed;
+	int flushes = 0;
+	world.observe<Energy>(ecs::ComponentEvent::Added, [&added, &flushes](ecs::Span<const ecs::uint64> ids)
+	{
+		added.assign(ids.begin(), ids.end());
+		flushes++;
+	});
+	const ecs::uint64 removal = world.observe<Energy>(ecs::ComponentEvent::Removed, [&removed](ecs::Span<const ecs::uint64> ids)
+	{
+		removed.assign(ids.begin(), ids.end());
+	});
+
+	const ecs::uint64 first = populate(world, 30u);  // 10 of them are charged
+	world.deleteEntity(first + 3u);  // added and removed again, it is not reported at all
+	world.deleteEntity(first + 1u);  // without energy
+	ECS_CHECK(added.empty());  // changes are batched until the flush
+	world.flushObservers();
+	ECS_CHECK(flushes == 1);
+	ECS_CHECK(added.size() == 9u);
+	ECS_CHECK(std::find(added.begin(), added.end(), first + 3u) == added.end());
+	ECS_CHECK(removed.empty());
+
+	world.flushObservers();  // nothing has changed
+	ECS_CHECK(flushes == 1);
+
+	world.deleteEntity(first + 6u);
+	world.runSystems();  // flushes observers too
+	ECS_CHECK((removed == std::vector<ecs::uint64>{first + 6u}));
+
+	world.unobserve(removal);
+	removed.clear();
+	world.deleteEntity(first + 9u);
+	world.flushObservers();
+	ECS_CHECK(removed.empty());
+}
+
+ECS_TEST(Observers, changesOfObserversGoToTheNextFlush)
+{
+	ecs::ThreadPool pool(2);
+	World world(1000u, pool);
+	ecs::Prefab<Pool> prefab;
+	prefab.set(Position{0.f, 0.f});
+	std::vector<std::size_t> batches;
+	world.observe<Position>(ecs::ComponentEvent::Added, [&world, &prefab, &batches](ecs::Span<const ecs::uint64> ids)
+	{
+		batches.push_back(ids.size());
+		if(batches.size() == 1u)
+		{
+			world.spawn(prefab, 2u);
+		}
+	});
+	world.spawn(prefab, 5u);
+	world.flushObservers();
+	ECS_CHECK((batches == std::vector<std::size_t>{5u}));
+	world.flushObservers();
+	ECS_CHECK((batches == std::vector<std::size_t>{5u, 2u}));
+}
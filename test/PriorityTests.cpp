@@ -0,0 +1,70 @@
+#include "Test.h"
+
+namespace
+{
+
+/**
+ * @brief Gets task options of the given priority.
+ */
+ecs::TaskOptions withPriority(const ecs::TaskPriority priority)
+{
+	return ecs::TaskOptions{0u, ecs::TaskOptions::anyNode, priority};
+}
+
+}  // namespace
+
+ECS_TEST(Priority, higherLevelsRunFirst)
+{
+	ecs::ThreadPool pool(1);
+	std::atomic<bool> started{false};
+	std::atomic<bool> released{false};
+	pool.addTask([&started, &released]() { started = true; ecs::test::waitFor([&released]() { return released.load(); }); });
+	ECS_CHECK(ecs::test::waitFor([&started]() { return started.load(); }));
+
+	std::mutex mutex;
+	std::string order;
+	const auto record = [&mutex, &order](const char name)
+	{
+		return [&mutex, &order, name](const int) { std::unique_lock<std::mutex> lock(mutex); order += name; };
+	};
+	pool.addTask(withPriority(ecs::TaskPriority::Background), record('b'));
+	pool.addTask(withPriority(ecs::TaskPriority::Normal), record('n'));
+	pool.addTask(withPriority(ecs::TaskPriority::High), record('h'));
+	pool.addTask(withPriority(ecs::TaskPriority::Normal), record('m'));
+	released = true;
+	ECS_CHECK(ecs::test::waitFor([&pool]() { return pool.pendingTasksCount() == 0u; }));
+	std::unique_lock<std::mutex> lock(mutex);
+	ECS_CHECK(order == "hnmb");  // FIFO within a level
+}
+
+ECS_TEST(Priority, backgroundLimitKeepsThreadsFree)
+{
+	ecs::ThreadPool pool(2);
+	pool.setBackgroundThreadLimit(1u);
+	ECS_CHECK(pool.backgroundThreadLimit() == 1u);
+
+	std::atomic<int> running{0};
+	std::atomic<int> finished{0};
+	std::atomic<bool> released{false};
+	for(int index = 0; index < 2; index++)
+	{
+		pool.addTask(withPriority(ecs::TaskPriority::Background), [&running, &finished, &released](const int)
+		{
+			running++;
+			ecs::test::waitFor([&released]() { return released.load(); });
+			running--;
+			finished++;
+		});
+	}
+	ECS_CHECK(ecs::test::waitFor([&running]() { return running == 1; }));
+
+	// the second thread is left for frame work instead of the other background task
+	auto normal = pool.addTask([&running]() { return running.load(); });
+	ECS_CHECK(normal.get() == 1);
+	ECS_CHECK(running == 1);
+	released = true;
+	ECS_CHECK(ecs::test::waitFor([&finished]() { return finished == 2; }));
+
+	pool.setBackgroundThreadLimit(0u);
+	ECS_CHECK(pool.backgroundThreadLimit() == 0u);
+}
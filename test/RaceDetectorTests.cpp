@@ -0,0 +1,64 @@
+#include "Test.h"
+
+using ecs::debug::Access;
+
+ECS_TEST(RaceDetector, conflictsBetweenThreads)
+{
+	ecs::debug::RaceDetector detector({"Position", "Velocity"});
+	int writer = 0;
+	int reader = 0;
+	std::atomic<bool> started{false};
+	std::atomic<bool> checked{false};
+	std::thread other([&]()
+	{
+		detector.beginSystem(&writer, "move", 0u, 1u);
+		started = true;
+		ecs::test::waitFor([&checked]() { return checked.load(); });
+		detector.endSystem();
+	});
+	ECS_CHECK(ecs::test::waitFor([&started]() { return started.load(); }));
+
+	detector.beginSystem(&reader, "draw", 1u, 0u);  // reads positions written by the other thread
+	detector.recordAccess(0u, Access::Read);
+	detector.recordAccess(1u, Access::Write);  // not declared
+	detector.endSystem();
+	detector.recordAccess(0u, Access::Write);  // unscheduled, the writer still runs
+	detector.beginSystem(&writer, "move", 0u, 1u);  // another range of the same system
+	detector.endSystem();
+	checked = true;
+	other.join();
+
+	const auto reports = detector.reports();
+	ECS_CHECK(reports.size() == 3u);
+	const auto contains = [&reports](const std::string &text)
+	{
+		return std::any_of(reports.begin(), reports.end(),
+			[&text](const std::string &report) { return report.find(text) != std::string::npos; });
+	};
+	ECS_CHECK(contains("read/write conflict on (Position)"));
+	ECS_CHECK(contains("undeclared write of (Velocity)"));
+	ECS_CHECK(contains("unscheduled write of (Position)"));
+
+	detector.clearReports();
+	detector.recordAccess(0u, Access::Write);  // nothing runs anymore
+	ECS_CHECK(detector.reports().empty());
+}
+
+ECS_TEST(RaceDetector, nestedSystemsRestoreTheOuterOne)
+{
+	ecs::debug::RaceDetector detector({"Position", "Velocity"});
+	int outer = 0;
+	int inner = 0;
+	detector.beginSystem(&outer, "outer", 0u, 1u);
+	detector.beginSystem(&inner, "inner", 1u, 2u);  // run by a helping wait(), no conflict with the outer one
+	detector.recordAccess(1u, Access::Write);
+	detector.endSystem();
+	ECS_CHECK(detector.reports().empty());
+
+	detector.recordAccess(0u, Access::Write);
+	detector.recordAccess(1u, Access::Write);  // the outer system did not declare it
+	detector.endSystem();
+	const auto reports = detector.reports();
+	ECS_CHECK(reports.size() == 1u);
+	ECS_CHECK(!reports.empty() && reports.front().find("system 'outer'") != std::string::npos);
+}
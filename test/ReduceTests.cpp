@@ -0,0 +1,50 @@
+#include "Test.h"
+
+ECS_TEST(Reduce, matchesSequentialResults)
+{
+	for(const unsigned threads : {0u, 3u})
+	{
+		ecs::ThreadPool pool(threads);
+		World world(10000u, pool);
+		populate(world, 6000u);
+
+		double sum = 0.0;
+		ecs::uint64 count = 0u;
+		float smallest = std::numeric_limits<float>::max();
+		float largest = std::numeric_limits<float>::lowest();
+		for(const auto &pos : world.getComponentBucket<Position>())
+		{
+			sum += pos().y;
+			count += pos().x > 5.f ? 1u : 0u;
+			smallest = std::min(smallest, pos().x);
+			largest = std::max(largest, pos().x);
+		}
+		ECS_CHECK(world.reduce(0.0, [](const Position &pos) { return double(pos.y); }, std::plus<>()) == sum);
+		ECS_CHECK(world.countIf([](const Position &pos) { return pos.x > 5.f; }) == count);
+		ECS_CHECK(*world.min([](const Position &pos) { return pos.x; }) == smallest);
+		ECS_CHECK(*world.max([](const Position &pos, const Velocity &) { return pos.x; }) == largest);
+		ECS_CHECK(world.reduce(0.0, [](const Energy &energy) { return energy.value; }, std::plus<>()) == 1000.0);
+		ECS_CHECK(world.countIf([](const Position &, const Energy &) { return true; }) == 2000u);
+	}
+}
+
+ECS_TEST(Reduce, groupsAndEmptyWorlds)
+{
+	ecs::ThreadPool pool(3);
+	World world(10000u, pool);
+	populate(world, 6000u);
+	const double expected = world.reduce(0.0, [](const Position &pos, const Velocity &vel) { return double(pos.y * vel.y); }, std::plus<>());
+	world.group<Position, Velocity>();  // walked over contiguous buckets now
+	ECS_CHECK(world.reduce(0.0, [](const Position &pos, const Velocity &vel) { return double(pos.y * vel.y); }, std::plus<>()) == expected);
+	ECS_CHECK(world.countIf([](const Position &, const Velocity &) { return true; }) == 6000u);
+
+	// results of any copyable type, every partial result starts from its own copy of init
+	const auto ids = world.reduce(std::vector<ecs::uint64>(), [](const Velocity &) { return std::vector<ecs::uint64>{1u}; },
+		[](std::vector<ecs::uint64> lhs, const std::vector<ecs::uint64> &rhs) { lhs.insert(lhs.end(), rhs.begin(), rhs.end()); return lhs; });
+	ECS_CHECK(ids.size() == 6000u);
+
+	ecs::ThreadPool single(1);
+	World empty(10u, single);
+	ECS_CHECK(!empty.min([](const Position &pos) { return pos.x; }).has_value());
+	ECS_CHECK(empty.reduce(7, [](const Position &) { return 1; }, std::plus<>()) == 7);
+}
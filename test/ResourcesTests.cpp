@@ -0,0 +1,79 @@
+#include "Test.h"
+
+namespace
+{
+
+struct Time { float delta; };
+struct Counter { std::atomic<int> hits{0}; };
+
+}  // namespace
+
+ECS_TEST(Resources, storedOncePerWorld)
+{
+	World world(100u);
+	ecs::Resources &resources = world.getResources();
+	ECS_CHECK(resources.find<Time>() == nullptr);
+	bool thrown = false;
+	try
+	{
+		resources.get<Time>();
+	}
+	catch(const std::out_of_range &)
+	{
+		thrown = true;
+	}
+	ECS_CHECK(thrown);
+
+	resources.emplace<Time>(Time{0.5f});
+	ECS_CHECK(resources.get<Time>().delta == 0.5f);
+	resources.emplace<Time>(Time{0.25f});  // replaces the existing one
+	ECS_CHECK(std::as_const(resources).get<Time>().delta == 0.25f);
+	resources.emplace<Counter>();
+	resources.remove<Time>();
+	ECS_CHECK(resources.find<Time>() == nullptr);
+	ECS_CHECK(resources.find<Counter>() != nullptr);
+	resources.clear();
+	ECS_CHECK(resources.find<Counter>() == nullptr);
+
+	World other(100u);
+	other.getResources().emplace<Time>(Time{1.f});
+	ECS_CHECK(world.getResources().find<Time>() == nullptr);
+}
+
+ECS_TEST(Resources, declaredAccessOrdersSystems)
+{
+	ECS_CHECK(ecs::ResourceAccess().writes<Time>().conflictsWith(ecs::ResourceAccess().reads<Time>()));
+	ECS_CHECK(ecs::ResourceAccess().writes<Time>().conflictsWith(ecs::ResourceAccess().writes<Time>()));
+	ECS_CHECK(!ecs::ResourceAccess().reads<Time>().conflictsWith(ecs::ResourceAccess().reads<Time>()));
+	ECS_CHECK(!ecs::ResourceAccess().writes<Time>().conflictsWith(ecs::ResourceAccess().writes<Counter>()));
+
+	ecs::ThreadPool pool(3);
+	World world(2000u, pool);
+	populate(world, 1000u);
+	world.getResources().emplace<Counter>();
+	world.getResources().emplace<Time>(Time{0.5f});
+
+	// components do not conflict, only the counter orders the systems
+	world.registerSystem([](ecs::Interface &itf, const Velocity &) { itf.resource<Counter>().hits++; },
+		"count", ecs::ResourceAccess().writes<Counter>());
+	world.registerSystem([](ecs::Interface &itf, Position &pos)
+	{
+		pos.x = static_cast<float>(itf.resource<Counter>().hits.load()) * itf.resource<Time>().delta;
+	}, "read", ecs::ResourceAccess().reads<Counter>().reads<Time>());
+	world.runSystems();
+	ECS_CHECK(world.getResources().get<Counter>().hits == 1000);
+	ECS_CHECK(world.countIf([](const Position &pos) { return pos.x == 500.f; }) == 1000u);
+
+	ecs::uint64 flags = 0u;
+	ecs::Interface bare(0u, 0u, flags, 0u);  // no resources at all
+	bool thrown = false;
+	try
+	{
+		bare.resource<Time>();
+	}
+	catch(const std::out_of_range &)
+	{
+		thrown = true;
+	}
+	ECS_CHECK(thrown);
+}
@@ -0,0 +1,56 @@
+#include "Test.h"
+
+ECS_TEST(SharedPool, worldsRunAsTasksOfTheirPool)
+{
+	ecs::ThreadPool pool(2);
+
+	// all workers wait for systems of their worlds, so waiting workers have to run the ranges
+	std::vector<std::unique_ptr<World>> worlds;
+	for(int index = 0; index < 6; index++)
+	{
+		worlds.push_back(std::make_unique<World>(10000u, pool));
+		populate(*worlds.back(), 6000u);
+		worlds.back()->registerSystem([](const Velocity &vel, Position &pos) { pos.x = vel.x; });
+	}
+	std::vector<std::future<double>> frames;
+	for(auto &world : worlds)
+	{
+		frames.push_back(pool.addTask([&world]()
+		{
+			world->runSystems();
+			return world->reduce(0.0, [](const Position &pos) { return double(pos.x); }, std::plus<>());
+		}));
+	}
+	for(auto &frame : frames)
+	{
+		ECS_CHECK(frame.get() == 6000.0);
+	}
+}
+
+ECS_TEST(SharedPool, waitingWorkerSkipsBackgroundAndInfiniteTasks)
+{
+	ecs::ThreadPool pool(1);
+	World world(2000u, pool);
+	populate(world, 1000u);
+	world.registerSystem([](Position &pos) { pos.x = 1.f; });
+
+	std::atomic<bool> frame_done{false};
+	std::atomic<bool> background_after_frame{false};
+	std::atomic<int> infinite_runs{0};
+	auto frame = pool.addTask([&]()
+	{
+		// both are queued before the ranges of the system, the only worker then waits for them
+		ecs::TaskOptions background;
+		background.priority = ecs::TaskPriority::Background;
+		pool.addTask(background, [&](const int) { background_after_frame = frame_done.load(); });
+		pool.addInfiniteTask([&infinite_runs]() { infinite_runs++; std::this_thread::sleep_for(std::chrono::milliseconds(1)); });
+		world.runSystems();
+		frame_done = true;
+		return infinite_runs.load();
+	});
+	ECS_CHECK(frame.get() == 0);
+	pool.haltInfinite();
+	ECS_CHECK(ecs::test::waitFor([&pool]() { return pool.pendingTasksCount() == 0u; }));
+	ECS_CHECK(background_after_frame);
+	ECS_CHECK(world.countIf([](const Position &pos) { return pos.x == 1.f; }) == 1000u);
+}
@@ -0,0 +1,61 @@
+#include "Test.h"
+
+ECS_TEST(Sort, bucketsFollowTheKey)
+{
+	ecs::ThreadPool pool(2);
+	World world(2000u, pool);
+	populate(world, 1000u);
+
+	world.sort<Position>([](const Position &lhs, const Position &rhs) { return lhs.x < rhs.x; });
+	const auto &positions = world.getComponentBucket<Position>();
+	const auto &velocities = world.getComponentBucket<Velocity>();
+	const auto &entities = world.getEntityBuffer();
+	bool sorted = true;
+	bool lockstep = true;
+	for(std::size_t index = 0u; index < positions.size(); index++)
+	{
+		sorted = sorted && (index == 0u || positions[index - 1u]().x <= positions[index]().x);
+		lockstep = lockstep && entities[index] == positions[index].eID() && velocities[index].eID() == entities[index];
+	}
+	ECS_CHECK(sorted);
+	ECS_CHECK(lockstep);
+
+	// energies are held by every third entity, they keep the relative entity order
+	const auto &energies = world.getComponentBucket<Energy>();
+	std::size_t entity = 0u;
+	bool ordered = true;
+	for(const auto &energy : energies)
+	{
+		while(entity < entities.size() && entities[entity] != energy.eID())
+		{
+			entity++;
+		}
+		ordered = ordered && entity < entities.size();
+	}
+	ECS_CHECK(ordered);
+	ECS_CHECK(energies.size() == 334u);
+}
+
+ECS_TEST(Sort, incrementalSortOfNearlySortedData)
+{
+	ecs::ThreadPool pool(2);
+	World world(2000u, pool);
+	const ecs::uint64 first = populate(world, 1000u);
+
+	world.sort<Position>([](const Position &lhs, const Position &rhs) { return lhs.y < rhs.y; }, ecs::SortMode::Incremental);
+	const auto &positions = world.getComponentBucket<Position>();
+	bool sorted = true;
+	for(std::size_t index = 1u; index < positions.size(); index++)
+	{
+		sorted = sorted && positions[index - 1u]().y <= positions[index]().y;
+	}
+	ECS_CHECK(sorted);
+	ECS_CHECK(world.getComponent<Velocity>(first + 500u).x == 1.f);  // lookups by id still work
+
+	const auto by_x = [](const Position &lhs, const Position &rhs) { return lhs.x < rhs.x; };
+	world.sort<Position>(by_x);
+	world.getComponentBucket<Position>()[10]().x = -1.f;  // one entity moved
+	world.sort<Position>(by_x, ecs::SortMode::Incremental);
+	ECS_CHECK(world.getComponentBucket<Position>()[0]().x == -1.f);
+	ECS_CHECK(world.getEntityBuffer()[0] == world.getComponentBucket<Position>()[0].eID());
+}
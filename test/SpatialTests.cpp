@@ -0,0 +1,66 @@
+#include "Test.h"
+
+ECS_TEST(Spatial, queriesMatchBruteForce)
+{
+	for(const unsigned threads : {0u, 3u})
+	{
+		ecs::ThreadPool pool(threads);
+		World world(5000u, pool);
+		populate(world, 4000u);
+		ecs::SpatialIndex grid(0.5f);
+		world.updateSpatialIndex<Position>(grid, [](const Position &pos)
+		{
+			return ecs::SpatialIndex::Point{pos.x, pos.y, 0.f};
+		});
+		ECS_CHECK(grid.size() == 4000u);
+
+		std::size_t inside_radius = 0u;
+		std::size_t inside_box = 0u;
+		for(const auto &pos : world.getComponentBucket<Position>())
+		{
+			const float dx = pos().x - 4.f;
+			const float dy = pos().y - 8.f;
+			inside_radius += dx * dx + dy * dy <= 9.f ? 1u : 0u;
+			inside_box += pos().x >= 1.f && pos().x <= 3.f && pos().y >= 2.f && pos().y <= 5.f ? 1u : 0u;
+		}
+		std::vector<ecs::uint64> buffer;
+		ECS_CHECK(grid.queryRadius({4.f, 8.f, 0.f}, 3.f, buffer).size() == inside_radius);
+		ECS_CHECK(grid.queryBox({1.f, 2.f, 0.f}, {3.f, 5.f, 0.f}, buffer).size() == inside_box);
+		ECS_CHECK(grid.queryRadius({0.f, 0.f, 0.f}, 1000.f, buffer).size() == 4000u);
+		ECS_CHECK(grid.queryBox({-1e30f, -1e30f, -1e30f}, {1e30f, 1e30f, 1e30f}, buffer).size() == 4000u);
+	}
+}
+
+ECS_TEST(Spatial, invalidQueriesAreEmpty)
+{
+	ecs::ThreadPool pool(2);
+	World world(1000u, pool);
+	populate(world, 500u);
+	ecs::SpatialIndex grid(1.f);
+	world.updateSpatialIndex<Position>(grid, [](const Position &pos)
+	{
+		return ecs::SpatialIndex::Point{pos.x, pos.y, 0.f};
+	});
+
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float inf = std::numeric_limits<float>::infinity();
+	std::vector<ecs::uint64> buffer{1u, 2u};
+	ECS_CHECK(grid.queryBox({3.f, 5.f, 0.f}, {1.f, 2.f, 0.f}, buffer).empty());  // inverted
+	ECS_CHECK(buffer.empty());
+	ECS_CHECK(grid.queryRadius({4.f, 8.f, 0.f}, -3.f, buffer).empty());
+	ECS_CHECK(grid.queryRadius({nan, 8.f, 0.f}, 3.f, buffer).empty());
+	ECS_CHECK(grid.queryRadius({4.f, 8.f, 0.f}, nan, buffer).empty());
+	ECS_CHECK(grid.queryBox({-inf, 0.f, 0.f}, {inf, 20.f, 0.f}, buffer).empty());
+	ECS_CHECK(grid.queryRadius({4.f, 8.f, 0.f}, 0.f, buffer).size() <= 1u);
+
+	// points which are not finite are indexed without undefined casts and never match a query
+	ecs::SpatialIndex odd(1.f);
+	const std::vector<ecs::SpatialIndex::Point> points{{nan, 0.f, 0.f}, {inf, 0.f, 0.f}, {1e30f, 0.f, 0.f}, {0.5f, 0.5f, 0.f}};
+	odd.build(pool, points.size(), [&points](const std::size_t index)
+	{
+		return std::pair<ecs::uint64, ecs::SpatialIndex::Point>(index, points[index]);
+	});
+	ECS_CHECK(odd.size() == 4u);
+	ECS_CHECK((odd.queryBox({0.f, 0.f, 0.f}, {1.f, 1.f, 0.f}, buffer).size() == 1u && buffer.front() == 3u));
+	ECS_CHECK((odd.queryBox({1e29f, -1.f, -1.f}, {1e31f, 1.f, 1.f}, buffer).size() == 1u && buffer.front() == 2u));
+}
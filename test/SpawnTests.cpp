@@ -0,0 +1,34 @@
+#include "Test.h"
+
+ECS_TEST(Spawn, prefabCopiesPrototypes)
+{
+	ecs::ThreadPool pool(2);
+	World world(1000u, pool);
+	ecs::Prefab<Pool> prefab(ecs::uint64{1} << 3);
+	prefab.set(Position{1.f, 2.f}).set(Energy{3.0});
+	ECS_CHECK(prefab.get<Position>().y == 2.f);
+
+	const ecs::uint64 first = world.spawn(prefab, 200u);
+	ECS_CHECK(world.getCurrentEntityCount() == 200u);
+	ECS_CHECK(world.getComponentBucket<Position>().size() == 200u);
+	ECS_CHECK(world.getComponentBucket<Energy>().size() == 200u);
+	ECS_CHECK(world.getComponentBucket<Velocity>().empty());
+	ECS_CHECK(world.getComponent<Energy>(first + 199u).value == 3.0);
+	ECS_CHECK(world.getFlag(ecs::uint64{1} << 3, first + 10u));
+	ECS_CHECK(world.getEntityBuffer()[57] == first + 57u);  // ids are consecutive
+}
+
+ECS_TEST(Spawn, batchesStopAtTheMaxCount)
+{
+	ecs::ThreadPool pool(2);
+	World world(100u, pool);
+	const ecs::uint64 first = world.addEntities(80u, 0u, 0u);
+	ECS_CHECK(world.getCurrentEntityCount() == 80u);
+
+	ecs::Prefab<Pool> prefab;
+	prefab.set(Velocity{1.f, 1.f});
+	world.spawn(prefab, 50u);  // only 20 entities fit
+	ECS_CHECK(world.getCurrentEntityCount() == 100u);
+	ECS_CHECK(world.getComponentBucket<Velocity>().size() == 20u);
+	ECS_CHECK(world.getEntityBuffer().front() == first);
+}
@@ -0,0 +1,37 @@
+#include "Test.h"
+
+ECS_TEST(Systems, conflictingSystemsRunInOrder)
+{
+	ecs::ThreadPool pool(3);
+	World world(2000u, pool);
+	populate(world, 1000u);
+
+	// the second system reads velocities written by the first, so it has to see the new values
+	world.registerSystem([](Velocity &vel) { vel.x *= 2.f; }, "accelerate");
+	world.registerSystem([](const Velocity &vel, Position &pos) { pos.x = vel.x * 0.5f; }, "move");
+	world.runSystems();
+	for(const auto &pos : world.getComponentBucket<Position>())
+	{
+		ECS_CHECK(pos().x == 1.f);
+	}
+}
+
+ECS_TEST(Systems, independentSystemsAndInterface)
+{
+	ecs::ThreadPool pool(3);
+	World world(2000u, pool);
+	const ecs::uint64 first = populate(world, 1000u);
+
+	std::atomic<ecs::uint64> charged{0u};
+	std::atomic<ecs::uint64> ids{0u};
+	world.registerSystem([&charged](const Energy &) { charged++; });
+	world.registerSystem([&ids](ecs::Interface &itf, Velocity &vel) { ids += itf.id(); vel.y = 0.f; });
+	world.runSystems();
+	ECS_CHECK(charged == 334u);
+	ECS_CHECK(ids == 1000u * first + 999u * 1000u / 2u);
+	ECS_CHECK(world.countIf([](const Velocity &vel) { return vel.y == 0.f; }) == 1000u);
+
+	world.clearSystems();
+	world.runSystems();
+	ECS_CHECK(charged == 334u);
+}
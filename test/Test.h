@@ -0,0 +1,120 @@
+#pragma once
+
+#include "../include/Manager.h"
+
+#include <limits>
+
+/**
+ * Feature tests run by ctest. Every *Tests.cpp file is one suite, registered as one ctest test:
+ *   ECSTests <suite>    runs tests of the single suite,
+ *   ECSTests            runs all of them.
+ * Failed checks are reported with their line and counted, a test passes if none of them failed.
+ */
+
+namespace ecs::test
+{
+
+using TestFunction = void (*)(int &failures);  /**< The body of a test, counting failed checks. */
+
+/**
+ * @brief The test registered by ECS_TEST().
+ */
+struct TestCase
+{
+	std::string suite;      /**< The name of the suite (the file). */
+	std::string name;       /**< The name of the test within the suite. */
+	TestFunction function;  /**< The body of the test. */
+};
+
+/**
+ * @brief Gets all registered tests.
+ * @return Tests in the order of registration.
+ */
+std::vector<TestCase> &registry();
+
+/**
+ * @brief Adds the test to the registry during static initialization.
+ */
+struct Registration
+{
+	Registration(const char *suite, const char *name, const TestFunction function);
+};
+
+/**
+ * @brief Polls the condition until it holds or the timeout passes.
+ * @param condition The checked condition.
+ * @param timeout The longest time to wait, generous so loaded machines do not fail tests.
+ * @return True if the condition holds.
+ */
+template <typename ConditionT>
+bool waitFor(ConditionT &&condition, const std::chrono::steady_clock::duration timeout = std::chrono::seconds(10))
+{
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+	while(!condition())
+	{
+		if(std::chrono::steady_clock::now() > deadline)
+		{
+			return condition();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+}  // namespace ecs::test
+
+#define ECS_CHECK(condition) \
+	do \
+	{ \
+		if(!(condition)) \
+		{ \
+			std::cerr << "[FAILED] " << __FILE__ << ":" << __LINE__ << ": " << #condition << std::endl; \
+			failures++; \
+		} \
+	} while(false)
+
+#define ECS_TEST(suite, name) \
+	static void suite##_##name(int &failures); \
+	static const ecs::test::Registration suite##_##name##_registration(#suite, #name, suite##_##name); \
+	static void suite##_##name([[maybe_unused]] int &failures)
+
+struct Position { float x, y; };
+struct Velocity { float x, y; };
+struct Energy { double value; };
+struct Transform { double local, world; };
+
+inline std::ostream &operator<<(std::ostream &os, const Position &pos) { return os << pos.x << " " << pos.y; }
+inline std::ostream &operator<<(std::ostream &os, const Velocity &vel) { return os << vel.x << " " << vel.y; }
+inline std::ostream &operator<<(std::ostream &os, const Energy &energy) { return os << energy.value; }
+inline std::ostream &operator<<(std::ostream &os, const Transform &tr) { return os << tr.local << " " << tr.world; }
+
+using Pool = ecs::meta::ComponentPool<Position, Velocity, Energy, Transform>;
+using World = ecs::Manager<Pool>;
+
+/**
+ * @brief Spawns entities with positions and velocities, every third one has energy as well.
+ * @param world The populated world.
+ * @param count The number of spawned entities.
+ * @return The id of the first spawned entity, ids are consecutive.
+ *
+ * Positions get scattered x in [0, 10) and y in [0, 17), velocities are {1, 2}, energies 0.5.
+ */
+inline ecs::uint64 populate(World &world, const ecs::uint64 count)
+{
+	ecs::Prefab<Pool> moving;
+	moving.set(Position{0.f, 0.f}).set(Velocity{1.f, 2.f});
+	ecs::Prefab<Pool> charged;
+	charged.set(Position{0.f, 0.f}).set(Velocity{1.f, 2.f}).set(Energy{0.5});
+	const ecs::uint64 first = world.spawn(charged, 1u);
+	for(ecs::uint64 index = 1u; index < count; index++)
+	{
+		world.spawn(index % 3u == 0u ? charged : moving, 1u);
+	}
+	ecs::uint64 index = 0u;
+	for(auto &pos : world.getComponentBucket<Position>())
+	{
+		pos().x = static_cast<float>((pos.eID() * 7919u) % 1000u) * 0.01f;
+		pos().y = static_cast<float>(index++ % 17u);
+	}
+	return first;
+}
@@ -0,0 +1,63 @@
+#include "Test.h"
+
+ECS_TEST(Timers, delayedTasks)
+{
+	ecs::ThreadPool pool(2);
+	std::atomic<int> delayed{0};
+	std::atomic<int> cancelled{0};
+	const auto start = std::chrono::steady_clock::now();
+	std::atomic<std::chrono::steady_clock::duration> waited{};
+	pool.addDelayedTask(std::chrono::milliseconds(5), [&delayed, &waited, start](const int)
+	{
+		waited = std::chrono::steady_clock::now() - start;
+		delayed++;
+	});
+	const auto once = pool.addDelayedTask(std::chrono::hours(1), [&cancelled](const int) { cancelled++; });
+	ECS_CHECK(pool.timerCount() >= 1u);
+	ECS_CHECK(pool.cancelTimer(once));
+	ECS_CHECK(!pool.cancelTimer(once));
+
+	ECS_CHECK(ecs::test::waitFor([&delayed]() { return delayed == 1; }));
+	ECS_CHECK(waited.load() >= std::chrono::milliseconds(5));
+	ECS_CHECK(ecs::test::waitFor([&pool]() { return pool.timerCount() == 0u; }));
+	ECS_CHECK(cancelled == 0);
+}
+
+ECS_TEST(Timers, periodicTasksStopWhenCancelled)
+{
+	ecs::ThreadPool pool(2);
+	std::atomic<int> periodic{0};
+	std::atomic<int> tokened{0};
+	const auto repeated = pool.addPeriodicTask(std::chrono::milliseconds(2), [&periodic](const int) { periodic++; });
+	ecs::CancellationSource source;
+	ecs::TaskOptions options;
+	options.token = source.token();
+	pool.addPeriodicTask(std::chrono::milliseconds(2), [&tokened](const int) { tokened++; },
+		ecs::PeriodicMode::FixedDelay, options);
+	ECS_CHECK(ecs::test::waitFor([&periodic, &tokened]() { return periodic >= 3 && tokened >= 3; }));
+
+	ECS_CHECK(pool.cancelTimer(repeated));
+	source.cancel();
+	// cancelled timers are released, so no more runs are scheduled
+	ECS_CHECK(ecs::test::waitFor([&pool]() { return pool.timerCount() == 0u && pool.pendingTasksCount() == 0u; }));
+	const int runs = periodic + tokened;
+
+	// the timer thread handles deadlines in order, so ticks of cancelled tasks would run before this one
+	std::atomic<bool> sentinel{false};
+	pool.addDelayedTask(std::chrono::milliseconds(20), [&sentinel](const int) { sentinel = true; });
+	ECS_CHECK(ecs::test::waitFor([&sentinel]() { return sentinel.load(); }));
+	ECS_CHECK(periodic + tokened == runs);
+}
+
+ECS_TEST(Timers, throwingPeriodicTaskIsCancelled)
+{
+	ecs::ThreadPool pool(1);
+	std::atomic<int> runs{0};
+	pool.addPeriodicTask(std::chrono::milliseconds(1), [&runs](const int)
+	{
+		runs++;
+		throw std::runtime_error("tick failed");
+	}, ecs::PeriodicMode::FixedRate);
+	ECS_CHECK(ecs::test::waitFor([&runs, &pool]() { return runs == 1 && pool.timerCount() == 0u; }));
+	ECS_CHECK(runs == 1);
+}
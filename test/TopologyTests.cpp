@@ -0,0 +1,25 @@
+#include "Test.h"
+
+ECS_TEST(Topology, parseCpuList)
+{
+	using ecs::CpuTopology;
+	ECS_CHECK((CpuTopology::parseCpuList("0-3,8,10-11") == std::vector<unsigned>{0u, 1u, 2u, 3u, 8u, 10u, 11u}));
+	ECS_CHECK((CpuTopology::parseCpuList("5\n") == std::vector<unsigned>{5u}));
+	ECS_CHECK(CpuTopology::parseCpuList("").empty());
+	ECS_CHECK((CpuTopology::parseCpuList("x,2,,4-4") == std::vector<unsigned>{2u, 4u}));  // malformed items are skipped
+}
+
+ECS_TEST(Topology, systemCoversEveryNode)
+{
+	const auto &topology = ecs::CpuTopology::system();
+	ECS_CHECK(!topology.cpus().empty());
+	ECS_CHECK(topology.nodeCount() >= 1u);
+	std::size_t cpu_count = 0u;
+	for(unsigned node = 0u; node < topology.nodeCount(); node++)
+	{
+		const auto cpus = topology.cpusOfNode(node);
+		ECS_CHECK(!cpus.empty());  // nodes are renumbered without gaps
+		cpu_count += cpus.size();
+	}
+	ECS_CHECK(cpu_count == topology.cpus().size());
+}
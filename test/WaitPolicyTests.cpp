@@ -0,0 +1,56 @@
+#include "Test.h"
+
+namespace
+{
+
+/**
+ * @brief Adds tasks to the pool and sums their results.
+ */
+int sumOfTasks(ecs::ThreadPool &pool, const int count)
+{
+	std::vector<std::future<int>> results;
+	for(int index = 0; index < count; index++)
+	{
+		results.push_back(pool.addTask([index]() { return index; }));
+	}
+	int sum = 0;
+	for(auto &result : results)
+	{
+		sum += result.get();
+	}
+	return sum;
+}
+
+}  // namespace
+
+ECS_TEST(WaitPolicy, everyPolicyRunsTasks)
+{
+	ecs::ThreadPool pool(2);
+	ECS_CHECK(pool.getWaitPolicy().spinCount == 0u);  // threads park by default
+	ECS_CHECK(sumOfTasks(pool, 100) == 4950);
+
+	pool.setWaitPolicy(ecs::WaitPolicy::balanced());
+	ECS_CHECK(pool.getWaitPolicy().spinCount == ecs::WaitPolicy::balanced().spinCount);
+	ECS_CHECK(pool.getWaitPolicy().yieldCount == ecs::WaitPolicy::balanced().yieldCount);
+	ECS_CHECK(sumOfTasks(pool, 100) == 4950);
+
+	pool.setWaitPolicy(ecs::WaitPolicy{16u, 0u});  // spinning straight into parking
+	ECS_CHECK(sumOfTasks(pool, 100) == 4950);
+}
+
+ECS_TEST(WaitPolicy, activeFramesNest)
+{
+	ecs::ThreadPool pool(2);
+	World world(2000u, pool);
+	populate(world, 1000u);
+
+	pool.beginActiveFrame();
+	pool.beginActiveFrame();  // e.g. another world sharing the pool
+	world.applySystemAsync([](Position &pos) { pos.x = 1.f; }).wait();
+	pool.endActiveFrame();
+	world.applySystemAsync([](const Position &pos, Velocity &vel) { vel.x = pos.x; }).wait();
+	pool.endActiveFrame();
+	pool.endActiveFrame();  // unmatched calls are ignored
+	ECS_CHECK(world.countIf([](const Velocity &vel) { return vel.x == 1.f; }) == 1000u);
+	ECS_CHECK(sumOfTasks(pool, 10) == 45);  // parked threads still wake up
+}
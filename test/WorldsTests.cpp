@@ -0,0 +1,39 @@
+#include "Test.h"
+
+ECS_TEST(Worlds, instancesAreIndependent)
+{
+	World first(100u);
+	World second(100u);
+	const ecs::uint64 first_id = populate(first, 10u);
+	const ecs::uint64 second_id = populate(second, 30u);
+	ECS_CHECK(first_id == second_id);  // every world counts ids on its own
+	ECS_CHECK(first.getCurrentEntityCount() == 10u);
+	ECS_CHECK(second.getCurrentEntityCount() == 30u);
+
+	first.deleteAllEntities();
+	ECS_CHECK(first.getComponentBucket<Position>().empty());
+	ECS_CHECK(second.getComponentBucket<Position>().size() == 30u);
+	ECS_CHECK(&first.getThreadPool() != &second.getThreadPool());
+}
+
+ECS_TEST(Worlds, externalPoolIsShared)
+{
+	ecs::ThreadPool pool(2);
+	World first(100u, pool);
+	World second(100u, pool);
+	ECS_CHECK(&first.getThreadPool() == &pool);
+	ECS_CHECK(&second.getThreadPool() == &pool);
+	populate(first, 50u);
+	populate(second, 50u);
+	first.registerSystem([](Position &pos) { pos.x = 1.f; });
+	second.registerSystem([](Position &pos) { pos.x = 2.f; });
+	first.runSystems();
+	second.runSystems();
+	ECS_CHECK(first.countIf([](const Position &pos) { return pos.x == 1.f; }) == 50u);
+	ECS_CHECK(second.countIf([](const Position &pos) { return pos.x == 2.f; }) == 50u);
+}
+
+ECS_TEST(Worlds, singletonIsOneWorld)
+{
+	ECS_CHECK(&World::getInstance() == &World::getInstance(5u));
+}